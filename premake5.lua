@@ -1,8 +1,94 @@
 workspace "Tetris"
     configurations { "debug", "release" }
-    platforms { "macosx", "web" }
+    platforms { "macosx", "linux", "web" }
     location "build"
 
+-- Rules, bots and maths that run without SDL or SoLoud, shared by the headless tools.
+headless_files = {
+    "src/core/base.h",
+    "src/core/utils.hpp",
+    "src/core/field.hpp",
+    "src/core/field.cpp",
+    "src/core/shape.hpp",
+    "src/core/shape.cpp",
+    "src/core/sim.hpp",
+    "src/core/sim.cpp",
+    "src/core/jobs.hpp",
+    "src/core/jobs.cpp",
+    "src/core/replay.hpp",
+    "src/core/replay.cpp",
+    "src/core/finesse.hpp",
+    "src/core/finesse.cpp",
+    "src/core/game_sim.hpp",
+    "src/core/game_sim.cpp",
+    "src/core/versus.hpp",
+    "src/core/versus.cpp",
+    "src/core/transport.hpp",
+    "src/core/transport.cpp",
+    "src/core/netplay.hpp",
+    "src/core/netplay.cpp",
+    "src/core/archive.hpp",
+    "src/core/archive.cpp",
+    "src/maths/**.hpp",
+    "src/maths/**.cpp",
+    "src/bots/**.hpp",
+    "src/bots/**.cpp",
+}
+
+-- Assets the game opens at runtime, packed into assets/assets.pak (see archive.hpp) before the
+-- game builds. Paths are relative to assets/, which is also the game's working directory.
+packed_assets = {
+    "pico/pico-8.ttf",
+    "audio/bgm_trimmed.ogg",
+}
+
+-- The parts of SoLoud the game uses: the core, wav/ogg decoding (see audio_load_sound) and sfxr
+-- (see audio_synth_sound). No other audio sources or filters are referenced, so they stay out of
+-- the binary and the wasm bundle. The backend is added per platform in the Tetris project.
+soloud_files = {
+    "vendor/soloud/include/**.h",
+    "vendor/soloud/src/core/**.cpp",
+    "vendor/soloud/src/audiosource/wav/**.h",
+    "vendor/soloud/src/audiosource/wav/**.c",
+    "vendor/soloud/src/audiosource/wav/**.cpp",
+    "vendor/soloud/src/audiosource/sfxr/**.cpp",
+}
+
+-- Common settings for the command line tools in src/tools (and libraries built on the same
+-- headless code, which pass a kind), none of which target the web.
+function headless_tool(name, sources, projectKind)
+    project (name)
+        kind (projectKind or "ConsoleApp")
+        pic "On"
+        location "build"
+        language "C++"
+        cppdialect "C++11"
+
+        targetdir "bin/%{cfg.platform}/%{cfg.buildcfg}/"
+        architecture "x86_64"
+        removeplatforms { "web" }
+
+        files (headless_files)
+        files (sources)
+
+        includedirs {
+            "src",
+        }
+
+        filter "configurations:debug"
+            defines { "CORTEX_DEBUG" }
+            symbols "On"
+
+        filter "configurations:release"
+            defines { "CORTEX_RELEASE" }
+            optimize "Speed"
+
+        filter "platforms:linux"
+            links { "pthread" }
+
+        filter {}
+end
+
 project "Tetris"
     kind "WindowedApp"
     location "build"
@@ -18,26 +104,15 @@ project "Tetris"
         "src/**.c",
         "src/**.hpp",
         "src/**.cpp",
-
-        -- soloud
-        "vendor/soloud/src/**.h",
-        "vendor/soloud/src/**.c",
-        "vendor/soloud/src/**.cpp",
-
-        "vendor/soloud/include/**.h",
-        "vendor/soloud/include/**.c",
-        "vendor/soloud/include/**.cpp",
     }
 
+    files (soloud_files)
+
     removefiles {
-        -- soloud
-        "vendor/soloud/src/tools/**.h",
-        "vendor/soloud/src/tools/**.c",
-        "vendor/soloud/src/tools/**.cpp",
-
-        "vendor/soloud/src/c_api/**.h",
-        "vendor/soloud/src/c_api/**.c",
-        "vendor/soloud/src/c_api/**.cpp",
+        -- headless tools, built by their own projects below
+        "src/bots/**",
+        "src/env/**",
+        "src/tools/**",
     }
 
     includedirs {
@@ -45,9 +120,12 @@ project "Tetris"
         "vendor/soloud/include",
     }
 
-    defines {
-        "WITH_SDL2_STATIC" -- select soloud backend
-    }
+    -- SoLoud backend, SDL2 everywhere (emscripten's port on the web) so only it is built.
+    filter "platforms:macosx or linux or web"
+        defines { "WITH_SDL2_STATIC" }
+        files { "vendor/soloud/src/backend/sdl2_static/**.cpp" }
+
+    filter {}
 
     externalincludedirs {
         "vendor/soloud/include",
@@ -61,10 +139,18 @@ project "Tetris"
         defines { "CORTEX_RELEASE" }
         optimize "On"
 
+    filter "platforms:macosx or linux"
+        dependson { "PackAssets" }
+        prebuildcommands {
+            "../bin/%{cfg.platform}/%{cfg.buildcfg}/pack-assets ../assets/assets.pak ../assets " .. table.concat(packed_assets, " "),
+        }
+
     filter "platforms:macosx"
         targetextension ("")
         links { "SDL2", "SDL2_TTF" }
 
+    filter "platforms:linux"
+        links { "SDL2", "SDL2_ttf", "pthread" }
 
     filter "platforms:web"
         architecture "x86"
@@ -83,5 +169,38 @@ project "Tetris"
             "-s USE_SDL=2",
             "-s USE_SDL_TTF=2",
             "-s ALLOW_MEMORY_GROWTH",
-            "--preload-file ../assets@/",
-        }
\ No newline at end of file
+            -- Only the configs, sound effects are synthesised and the asset archive is fetched
+            -- while the loading screen shows, so it never holds up the first frame.
+            "--preload-file ../assets/keybinds.cfg@/keybinds.cfg",
+            "--preload-file ../assets/handling.cfg@/handling.cfg",
+        }
+
+        -- Served next to index.html. It has to be packed by a desktop build first, see the README.
+        postbuildcommands {
+            "{COPYFILE} ../assets/assets.pak %{cfg.targetdir}/assets.pak",
+        }
+
+    filter {}
+
+headless_tool("AgentBench", { "src/tools/agent_bench.cpp" })
+headless_tool("NetworkBench", { "src/tools/network_bench.cpp" })
+headless_tool("PcBench", { "src/tools/pc_bench.cpp" })
+headless_tool("FinesseReport", { "src/tools/finesse_report.cpp" })
+headless_tool("VersusBench", { "src/tools/versus_bench.cpp" })
+headless_tool("NetplayLoopback", { "src/tools/netplay_loopback.cpp" })
+
+headless_tool("PackAssets", { "src/tools/pack_assets.cpp" })
+    targetname "pack-assets"
+
+headless_tool("TetrisTournament", { "src/tools/tournament.cpp" })
+    targetname "tetris-tournament"
+headless_tool("WeightTuner", { "src/tools/weight_tuner.cpp" })
+
+headless_tool("TbpFrontend", { "src/tools/tbp_frontend.cpp" })
+    -- stdout carries protocol messages, so logging has to stay off.
+    defines { "CORTEX_NO_LOGGING" }
+
+-- C ABI for reinforcement learning, see src/env/tetris_vec_env.h.
+headless_tool("TetrisVecEnv", { "src/env/**.h", "src/env/**.cpp" }, "SharedLib")
+
+headless_tool("DatasetExport", { "src/tools/dataset_export.cpp" })
@@ -0,0 +1,148 @@
+#include "bots/dataset.hpp"
+
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+// Records are staged and written in chunks of this many, roughly 200KB per write.
+#define DATASET_WRITE_CHUNK 4096
+
+struct DatasetWriter {
+    FILE* File;
+    DatasetHeader Header;
+    DatasetRecord Pending[DATASET_WRITE_CHUNK];
+    u32 PendingCount;
+};
+
+static void dataset_writer_flush(DatasetWriter* writer) {
+    if (writer->PendingCount) {
+        fwrite(writer->Pending, sizeof(DatasetRecord), writer->PendingCount, writer->File);
+        writer->Header.RecordCount += writer->PendingCount;
+        writer->PendingCount = 0;
+    }
+}
+
+DatasetWriter* dataset_writer_open(const char* path) {
+    FILE* file = fopen(path, "wb");
+    if (!file) {
+        CX_ERROR("Failed to open %s for writing.", path);
+        return nullptr;
+    }
+
+    DatasetWriter* writer = new DatasetWriter();
+    writer->File = file;
+    writer->PendingCount = 0;
+    memset(&writer->Header, 0, sizeof(writer->Header));
+    memcpy(writer->Header.Magic, DATASET_MAGIC, sizeof(writer->Header.Magic));
+    writer->Header.Version = DATASET_VERSION;
+    writer->Header.RecordSize = sizeof(DatasetRecord);
+    writer->Header.FieldWidth = FIELD_WIDTH;
+    writer->Header.FieldHeight = FIELD_HEIGHT;
+
+    // Written again with the final record count on close.
+    fwrite(&writer->Header, sizeof(writer->Header), 1, file);
+    return writer;
+}
+
+void dataset_writer_close(DatasetWriter* writer) {
+    dataset_writer_flush(writer);
+    fseek(writer->File, 0, SEEK_SET);
+    fwrite(&writer->Header, sizeof(writer->Header), 1, writer->File);
+    fclose(writer->File);
+    delete writer;
+}
+
+void dataset_writer_append(DatasetWriter* writer, const DatasetRecord* records, u32 count) {
+    while (count > 0) {
+        u32 space = DATASET_WRITE_CHUNK - writer->PendingCount;
+        u32 batch = count < space ? count : space;
+        memcpy(&writer->Pending[writer->PendingCount], records, sizeof(DatasetRecord) * batch);
+        writer->PendingCount += batch;
+        records += batch;
+        count -= batch;
+        if (writer->PendingCount == DATASET_WRITE_CHUNK) {
+            dataset_writer_flush(writer);
+        }
+    }
+}
+
+u64 dataset_writer_count(DatasetWriter* writer) {
+    return writer->Header.RecordCount + writer->PendingCount;
+}
+
+void dataset_record_init(DatasetRecord& record, const SimState& state, const Placement& placement) {
+    memset(&record, 0, sizeof(record));
+    field_to_rows(state.Field, record.Rows);
+    record.CurrentID = (u8)state.CurrentID;
+    record.NextID = (u8)state.NextID;
+    record.X = placement.X;
+    record.Y = placement.Y;
+    record.Rotation = placement.Rotation;
+    record.Swap = placement.Swap;
+}
+
+/*
+    Fills in the outcome fields of one game's records, walking back from the last placement.
+*/
+
+void dataset_finish_game(DatasetRecord* records, u32 count, bool toppedOut) {
+    u32 lines = 0;
+    for (u32 i = count; i-- > 0;) {
+        lines += records[i].LinesCleared;
+        records[i].ToppedOut = toppedOut;
+        records[i].PiecesRemaining = (u16)(count - i < 0xFFFF ? count - i : 0xFFFF);
+        records[i].LinesRemaining = (u16)(lines < 0xFFFF ? lines : 0xFFFF);
+    }
+}
+
+bool dataset_map(const char* path, DatasetView* view) {
+    memset(view, 0, sizeof(*view));
+
+    i32 fd = open(path, O_RDONLY);
+    if (fd < 0) {
+        CX_ERROR("Failed to open %s.", path);
+        return false;
+    }
+
+    struct stat info;
+    if (fstat(fd, &info) != 0 || (u64)info.st_size < sizeof(DatasetHeader)) {
+        CX_ERROR("%s is too small to be a dataset.", path);
+        close(fd);
+        return false;
+    }
+
+    void* mapping = mmap(nullptr, (size_t)info.st_size, PROT_READ, MAP_PRIVATE, fd, 0);
+    close(fd);
+    if (mapping == MAP_FAILED) {
+        CX_ERROR("Failed to map %s.", path);
+        return false;
+    }
+
+    const DatasetHeader* header = (const DatasetHeader*)mapping;
+    u64 available = ((u64)info.st_size - sizeof(DatasetHeader)) / sizeof(DatasetRecord);
+    bool isValid = memcmp(header->Magic, DATASET_MAGIC, sizeof(header->Magic)) == 0
+        && header->Version == DATASET_VERSION
+        && header->RecordSize == sizeof(DatasetRecord)
+        && header->FieldWidth == FIELD_WIDTH
+        && header->FieldHeight == FIELD_HEIGHT
+        && header->RecordCount <= available;
+    if (!isValid) {
+        CX_ERROR("%s is not a compatible dataset.", path);
+        munmap(mapping, (size_t)info.st_size);
+        return false;
+    }
+
+    view->Records = (const DatasetRecord*)((const u8*)mapping + sizeof(DatasetHeader));
+    view->RecordCount = header->RecordCount;
+    view->Mapping = mapping;
+    view->MappingSize = (u64)info.st_size;
+    return true;
+}
+
+void dataset_unmap(DatasetView* view) {
+    if (view->Mapping) {
+        munmap(view->Mapping, (size_t)view->MappingSize);
+    }
+    memset(view, 0, sizeof(*view));
+}
@@ -0,0 +1,68 @@
+#pragma once
+
+#include "core/base.h"
+#include "core/sim.hpp"
+
+/*
+    Board/placement datasets for training. A dataset shard is a 32 byte header followed by a
+    flat array of fixed-width records, so a loader can mmap the file and index records directly.
+    Outcome fields are filled in once the game a record came from has finished.
+*/
+
+#define DATASET_MAGIC "TTRSDATA"
+#define DATASET_VERSION 1
+
+struct DatasetHeader {
+    char Magic[8];
+    u32 Version;
+    u32 RecordSize;
+    u64 RecordCount;
+    u32 FieldWidth;
+    u32 FieldHeight;
+};
+
+STATIC_ASSERT(sizeof(DatasetHeader) == 32, "Dataset header layout must not change.");
+
+struct DatasetRecord {
+    u16 Rows[FIELD_HEIGHT];  // Board before the placement, see field_to_rows.
+    u8 CurrentID;
+    u8 NextID;
+    i8 X;                    // Chosen placement.
+    i8 Y;
+    u8 Rotation;
+    u8 Swap;
+    u8 LinesCleared;         // Lines cleared by this placement.
+    u8 ToppedOut;            // Whether the game ended by topping out rather than the piece cap.
+    u16 PiecesRemaining;     // Pieces placed from here to the end of the game, this one included.
+    u16 LinesRemaining;      // Lines cleared from here to the end of the game, this one included.
+};
+
+STATIC_ASSERT(sizeof(DatasetRecord) == 48, "Dataset record layout must not change.");
+
+/*
+    Writing
+*/
+
+struct DatasetWriter;
+
+DatasetWriter* dataset_writer_open(const char* path);
+void dataset_writer_close(DatasetWriter* writer);
+void dataset_writer_append(DatasetWriter* writer, const DatasetRecord* records, u32 count);
+u64 dataset_writer_count(DatasetWriter* writer);
+
+void dataset_record_init(DatasetRecord& record, const SimState& state, const Placement& placement);
+void dataset_finish_game(DatasetRecord* records, u32 count, bool toppedOut);
+
+/*
+    Reading, through a read-only memory map.
+*/
+
+struct DatasetView {
+    const DatasetRecord* Records;
+    u64 RecordCount;
+    void* Mapping;
+    u64 MappingSize;
+};
+
+bool dataset_map(const char* path, DatasetView* view);
+void dataset_unmap(DatasetView* view);
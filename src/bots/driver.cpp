@@ -0,0 +1,56 @@
+#include "bots/driver.hpp"
+
+void driver_start(InputDriver& driver, const Placement& target) {
+    driver.Target = target;
+    driver.Active = true;
+    driver.Swapped = false;
+    driver.Presses = 0;
+}
+
+/*
+    Returns the input for this tick, and goes inactive once it has pressed the hard drop so the
+    caller knows to pick the next placement.
+*/
+
+GameInput driver_next_input(InputDriver& driver, const GameSim& sim) {
+    GameInput input = {};
+    if (!driver.Active) {
+        return input;
+    }
+
+    bool giveUp = driver.Presses >= DRIVER_MAX_PRESSES;
+    driver.Presses++;
+
+    if (!giveUp && driver.Target.Swap && !driver.Swapped) {
+        input.Pressed = GAME_INPUT_SWAP;
+        driver.Swapped = true;
+    } else if (!giveUp && shape_get_rotation(sim.CurrentShape) != driver.Target.Rotation) {
+        input.Pressed = GAME_INPUT_UP;
+    } else if (!giveUp && sim.PlayerX < driver.Target.X) {
+        input.Pressed = GAME_INPUT_RIGHT;
+    } else if (!giveUp && sim.PlayerX > driver.Target.X) {
+        input.Pressed = GAME_INPUT_LEFT;
+    } else {
+        input.Pressed = GAME_INPUT_SPACE;
+        driver.Active = false;
+    }
+    return input;
+}
+
+/*
+    The placement-level view of a game in progress, for bots to pick from. Only valid while the
+    current piece is still at its spawn, which is when the driver asks for a new placement.
+*/
+
+SimState driver_sim_state(const GameSim& sim) {
+    SimState state;
+    memcpy(state.Field, sim.Field, sizeof(state.Field));
+    state.CurrentID = sim.CurrentShape.ID;
+    state.NextID = sim.NextShape.ID;
+    state.Seed = sim.Seed;
+    state.Score = sim.Score;
+    state.Lines = 0;
+    state.Pieces = 0;
+    state.IsOver = sim.GameState == GameState::GameOver;
+    return state;
+}
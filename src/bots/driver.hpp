@@ -0,0 +1,26 @@
+#pragma once
+
+#include "core/base.h"
+#include "core/sim.hpp"
+#include "core/game_sim.hpp"
+
+/*
+    Plays a chosen Placement into a GameSim one input per tick, the way a player would: swap,
+    rotate, tap sideways, hard drop. Lets the placement-level bots take part in anything that
+    runs at input level, such as versus matches. Taps are used rather than holds so a piece is
+    in place in a handful of ticks whatever the key repeat speed.
+*/
+
+struct InputDriver {
+    Placement Target;
+    bool Active;
+    bool Swapped;
+    u8 Presses; // Gives up and drops where it is if the target turns out to be unreachable.
+};
+
+// Pieces need at most 1 swap, 3 rotations and 9 slides, anything more means the way is blocked.
+#define DRIVER_MAX_PRESSES 16
+
+void driver_start(InputDriver& driver, const Placement& target);
+GameInput driver_next_input(InputDriver& driver, const GameSim& sim);
+SimState driver_sim_state(const GameSim& sim);
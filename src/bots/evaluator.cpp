@@ -0,0 +1,190 @@
+#include "bots/evaluator.hpp"
+
+static const char* s_FeatureNames[EVAL_FEATURE_COUNT] = {
+    "aggregate_height",
+    "max_height",
+    "holes",
+    "bumpiness",
+    "wells",
+    "row_transitions",
+    "col_transitions",
+    "lines_cleared",
+};
+
+/*
+    Starting point taken from the usual four-feature heuristic (height, lines, holes, bumpiness),
+    with the extra features weighted lightly until they have been tuned.
+*/
+
+EvalWeights evaluator_default_weights() {
+    EvalWeights weights = {};
+    weights.Values[EVAL_FEATURE_AGGREGATE_HEIGHT] = -0.510f;
+    weights.Values[EVAL_FEATURE_MAX_HEIGHT] = -0.050f;
+    weights.Values[EVAL_FEATURE_HOLES] = -0.357f;
+    weights.Values[EVAL_FEATURE_BUMPINESS] = -0.184f;
+    weights.Values[EVAL_FEATURE_WELLS] = -0.050f;
+    weights.Values[EVAL_FEATURE_ROW_TRANSITIONS] = -0.050f;
+    weights.Values[EVAL_FEATURE_COL_TRANSITIONS] = -0.050f;
+    weights.Values[EVAL_FEATURE_LINES_CLEARED] = 0.761f;
+    return weights;
+}
+
+const char* evaluator_feature_name(u32 feature) {
+    CX_DEBUGASSERT(feature < EVAL_FEATURE_COUNT, "Feature index out of range!");
+    return s_FeatureNames[feature];
+}
+
+/*
+    Weights files are plain text, one "feature_name value" pair per line. Features missing from
+    a file keep whatever value they had before loading.
+*/
+
+bool evaluator_save_weights(const char* path, const EvalWeights& weights) {
+    FILE* file = fopen(path, "w");
+    if (!file) {
+        CX_ERROR("Failed to open %s for writing.", path);
+        return false;
+    }
+    for (u32 i = 0; i < EVAL_FEATURE_COUNT; i++) {
+        fprintf(file, "%s %.6f\n", s_FeatureNames[i], weights.Values[i]);
+    }
+    fclose(file);
+    return true;
+}
+
+bool evaluator_load_weights(const char* path, EvalWeights* weights) {
+    FILE* file = fopen(path, "r");
+    if (!file) {
+        CX_ERROR("Failed to open %s for reading.", path);
+        return false;
+    }
+
+    char name[64];
+    f32 value;
+    while (fscanf(file, "%63s %f", name, &value) == 2) {
+        for (u32 i = 0; i < EVAL_FEATURE_COUNT; i++) {
+            if (strcmp(name, s_FeatureNames[i]) == 0) {
+                weights->Values[i] = value;
+                break;
+            }
+        }
+    }
+    fclose(file);
+    return true;
+}
+
+/*
+    Features are computed on the packed rows (see field_to_rows) with bit operations, a row at a
+    time, since this runs for every candidate placement the search looks at. Row 0 is the bottom
+    row, so a column's height is one past its highest filled cell.
+*/
+
+void evaluator_features(const u16* rows, u32 linesCleared, f32* features) {
+    i32 heights[FIELD_WIDTH] = {};
+    i32 holes = 0;
+    i32 colTransitions = 0;
+    i32 rowTransitions = 0;
+
+    // Walk down from the top, `covered` holding the columns with a filled cell above this row.
+    u32 covered = 0;
+    for (i32 row = FIELD_HEIGHT - 1; row >= 0; row--) {
+        u32 bits = rows[row];
+        holes += __builtin_popcount(covered & ~bits);
+
+        u32 tops = bits & ~covered;
+        while (tops) {
+            i32 col = __builtin_ctz(tops);
+            heights[col] = row + 1;
+            tops &= tops - 1;
+        }
+        covered |= bits;
+
+        // The floor counts as filled for column transitions.
+        u32 below = row > 0 ? rows[row - 1] : SIM_FULL_ROW;
+        colTransitions += __builtin_popcount(bits ^ below);
+
+        // The walls count as filled for row transitions. Rows above the stack only contribute
+        // their two wall transitions, which tells us nothing, so they are skipped.
+        if (bits) {
+            u32 walled = (bits << 1) | 1 | (1 << (FIELD_WIDTH + 1));
+            rowTransitions += __builtin_popcount((walled ^ (walled >> 1)) & ((1 << (FIELD_WIDTH + 1)) - 1));
+        }
+    }
+
+    i32 aggregateHeight = 0;
+    i32 maxHeight = 0;
+    i32 bumpiness = 0;
+    i32 wells = 0;
+    for (i32 col = 0; col < FIELD_WIDTH; col++) {
+        aggregateHeight += heights[col];
+        maxHeight = heights[col] > maxHeight ? heights[col] : maxHeight;
+        if (col + 1 < FIELD_WIDTH) {
+            i32 diff = heights[col] - heights[col + 1];
+            bumpiness += diff < 0 ? -diff : diff;
+        }
+
+        i32 left = col > 0 ? heights[col - 1] : FIELD_HEIGHT;
+        i32 right = col + 1 < FIELD_WIDTH ? heights[col + 1] : FIELD_HEIGHT;
+        i32 rim = left < right ? left : right;
+        if (rim > heights[col]) {
+            wells += rim - heights[col];
+        }
+    }
+
+    features[EVAL_FEATURE_AGGREGATE_HEIGHT] = (f32)aggregateHeight;
+    features[EVAL_FEATURE_MAX_HEIGHT] = (f32)maxHeight;
+    features[EVAL_FEATURE_HOLES] = (f32)holes;
+    features[EVAL_FEATURE_BUMPINESS] = (f32)bumpiness;
+    features[EVAL_FEATURE_WELLS] = (f32)wells;
+    features[EVAL_FEATURE_ROW_TRANSITIONS] = (f32)rowTransitions;
+    features[EVAL_FEATURE_COL_TRANSITIONS] = (f32)colTransitions;
+    features[EVAL_FEATURE_LINES_CLEARED] = (f32)linesCleared;
+}
+
+f32 evaluator_score(const EvalWeights& weights, const u16* rows, u32 linesCleared) {
+    f32 features[EVAL_FEATURE_COUNT];
+    evaluator_features(rows, linesCleared, features);
+
+    f32 score = 0.0f;
+    for (u32 i = 0; i < EVAL_FEATURE_COUNT; i++) {
+        score += weights.Values[i] * features[i];
+    }
+    return score;
+}
+
+f32 evaluator_score_field(const EvalWeights& weights, const u32* field, u32 linesCleared) {
+    u16 rows[FIELD_HEIGHT];
+    field_to_rows(field, rows);
+    return evaluator_score(weights, rows, linesCleared);
+}
+
+/*
+    One-ply greedy search: try every placement of the current piece and keep the best board.
+    Returns false if there is nothing to place (the game is over).
+*/
+
+bool evaluator_pick_placement(const SimState& state, const EvalWeights& weights, bool allowSwap, Placement* result) {
+    Placement placements[SIM_MAX_PLACEMENTS];
+    u32 count = sim_get_placements(state, placements, allowSwap);
+    if (count == 0) {
+        return false;
+    }
+
+    u16 rows[FIELD_HEIGHT];
+    u16 preview[FIELD_HEIGHT];
+    field_to_rows(state.Field, rows);
+
+    f32 bestScore = 0.0f;
+    u32 bestIndex = 0;
+    for (u32 i = 0; i < count; i++) {
+        u32 lineCount = sim_preview_placement(state, rows, placements[i], preview);
+        f32 score = evaluator_score(weights, preview, lineCount);
+        if (i == 0 || score > bestScore) {
+            bestScore = score;
+            bestIndex = i;
+        }
+    }
+
+    *result = placements[bestIndex];
+    return true;
+}
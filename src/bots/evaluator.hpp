@@ -0,0 +1,36 @@
+#pragma once
+
+#include "core/base.h"
+#include "core/sim.hpp"
+
+/*
+    Hand-written board heuristic. A board is reduced to a handful of features and scored as
+    their weighted sum, higher is better. Weights are plain floats so they can be tuned offline.
+*/
+
+enum EvalFeature {
+    EVAL_FEATURE_AGGREGATE_HEIGHT = 0,
+    EVAL_FEATURE_MAX_HEIGHT,
+    EVAL_FEATURE_HOLES,
+    EVAL_FEATURE_BUMPINESS,
+    EVAL_FEATURE_WELLS,
+    EVAL_FEATURE_ROW_TRANSITIONS,
+    EVAL_FEATURE_COL_TRANSITIONS,
+    EVAL_FEATURE_LINES_CLEARED,
+    EVAL_FEATURE_COUNT
+};
+
+struct EvalWeights {
+    f32 Values[EVAL_FEATURE_COUNT];
+};
+
+EvalWeights evaluator_default_weights();
+const char* evaluator_feature_name(u32 feature);
+bool evaluator_save_weights(const char* path, const EvalWeights& weights);
+bool evaluator_load_weights(const char* path, EvalWeights* weights);
+
+void evaluator_features(const u16* rows, u32 linesCleared, f32* features);
+f32 evaluator_score(const EvalWeights& weights, const u16* rows, u32 linesCleared);
+f32 evaluator_score_field(const EvalWeights& weights, const u32* field, u32 linesCleared);
+
+bool evaluator_pick_placement(const SimState& state, const EvalWeights& weights, bool allowSwap, Placement* result);
@@ -0,0 +1,323 @@
+#include "bots/mcts.hpp"
+
+#include "maths/random.hpp"
+
+#include <cmath>
+
+/*
+    Bump allocator for tree nodes. The whole tree is thrown away between moves, so there is no
+    per-node free, just a reset.
+*/
+
+struct MCTSPool {
+    MCTSNode* Nodes;
+    u32 Capacity;
+    u32 Count;
+};
+
+static void mcts_pool_reset(MCTSPool& pool) {
+    pool.Count = 0;
+}
+
+// Returns the index of the first of `count` fresh nodes, or 0 if the pool is exhausted.
+static u32 mcts_pool_alloc(MCTSPool& pool, u32 count) {
+    if (pool.Count + count > pool.Capacity) {
+        return 0;
+    }
+    u32 first = pool.Count;
+    pool.Count += count;
+    memset(&pool.Nodes[first], 0, sizeof(MCTSNode) * count);
+    return first;
+}
+
+struct MCTSBatchSlot {
+    SimState State;
+    u32 Path[MCTS_MAX_TREE_DEPTH + 1];
+    u32 PathLength;
+    u32 RootScore;
+    u32 RolloutPieces;
+    f32 Value;
+    bool NeedsRollout;
+};
+
+/*
+    Padded to a cache line each, since every rollout writes its worker's seed back and
+    neighbouring workers would otherwise keep stealing the same line from each other. At a
+    64 byte stride no two seeds can share a line wherever new[] puts the array.
+*/
+
+struct MCTSThreadSeed {
+    u32 Seed;
+    u8 Padding[60];
+};
+
+STATIC_ASSERT(sizeof(MCTSThreadSeed) == 64, "Thread seeds must fill a cache line each.");
+
+struct MCTSAgent {
+    MCTSConfig Config;
+    MCTSPool Pool;
+    JobPool* Jobs;
+    MCTSThreadSeed* ThreadSeeds;
+    MCTSBatchSlot* Batch;
+    MCTSStats Stats;
+};
+
+MCTSAgent* mcts_create(const MCTSConfig& config, JobPool* jobs) {
+    CX_ASSERT(config.BatchSize > 0, "MCTS batch size must be non-zero!");
+
+    MCTSAgent* agent = new MCTSAgent();
+    agent->Config = config;
+    agent->Jobs = jobs;
+
+    agent->Pool.Nodes = new MCTSNode[config.NodeCapacity];
+    agent->Pool.Capacity = config.NodeCapacity;
+    agent->Pool.Count = 0;
+
+    agent->Batch = new MCTSBatchSlot[config.BatchSize];
+
+    // Each worker gets its own RNG stream so rollouts never contend on shared state.
+    u32 threadCount = jobs_thread_count(jobs);
+    agent->ThreadSeeds = new MCTSThreadSeed[threadCount];
+    for (u32 i = 0; i < threadCount; i++) {
+        agent->ThreadSeeds[i].Seed = Utils::HashPCG(config.Seed ^ Utils::HashPCG(i + 1));
+    }
+
+    agent->Stats = {};
+    return agent;
+}
+
+void mcts_destroy(MCTSAgent* agent) {
+    delete[] agent->ThreadSeeds;
+    delete[] agent->Batch;
+    delete[] agent->Pool.Nodes;
+    delete agent;
+}
+
+MCTSStats mcts_get_stats(MCTSAgent* agent) {
+    return agent->Stats;
+}
+
+/*
+    Rollouts
+*/
+
+static bool mcts_default_policy(const MCTSConfig& config, const SimState& state, u32& seed, Placement* result) {
+    if (config.RolloutPolicy == MCTSRolloutPolicy::Greedy) {
+        if (config.Net) {
+            return network_pick_placement(config.Net, state, false, result);
+        }
+        return evaluator_pick_placement(state, config.Weights, false, result);
+    }
+
+    Placement placements[SIM_MAX_PLACEMENTS];
+    u32 count = sim_get_placements(state, placements, false);
+    if (count == 0) {
+        return false;
+    }
+    *result = placements[RandU32(seed, 0, count - 1)];
+    return true;
+}
+
+/*
+    Plays the default policy forward from the slot's state, and values the outcome as the score
+    earned since the root (in tetrises) plus the heuristic value, per column, of wherever the
+    rollout ended up. Neither the weights nor a network are bounded, so the board's value is
+    floored just above GameOverValue: a live board must never look worse than losing.
+*/
+
+#define MCTS_ALIVE_MARGIN 1.0f
+
+static void mcts_rollout_job(void* userData, u32 index, u32 threadIndex) {
+    MCTSAgent* agent = (MCTSAgent*)userData;
+    MCTSBatchSlot& slot = agent->Batch[index];
+    if (!slot.NeedsRollout) {
+        return;
+    }
+
+    u32& seed = agent->ThreadSeeds[threadIndex].Seed;
+    SimState& state = slot.State;
+
+    for (u32 i = 0; i < agent->Config.RolloutDepth && !state.IsOver; i++) {
+        Placement placement;
+        if (!mcts_default_policy(agent->Config, state, seed, &placement)) {
+            break;
+        }
+        sim_apply_placement(state, placement);
+        slot.RolloutPieces++;
+    }
+
+    if (state.IsOver) {
+        slot.Value = agent->Config.GameOverValue;
+    } else {
+        f32 earned = (f32)(state.Score - slot.RootScore) / (f32)sim_line_clear_score(4);
+        f32 board = agent->Config.Net
+            ? network_score_field(agent->Config.Net, state.Field, 0)
+            : evaluator_score_field(agent->Config.Weights, state.Field, 0) / (f32)FIELD_WIDTH;
+        f32 floor = agent->Config.GameOverValue + MCTS_ALIVE_MARGIN;
+        slot.Value = earned + (board > floor ? board : floor);
+    }
+}
+
+/*
+    Tree policy
+*/
+
+static void mcts_expand(MCTSAgent* agent, u32 nodeIndex, const SimState& state, u32 depth) {
+    Placement placements[SIM_MAX_PLACEMENTS];
+
+    // Swapping only makes sense at the root, below it the next piece is not known yet.
+    u32 count = sim_get_placements(state, placements, depth == 0);
+    if (count == 0) {
+        return;
+    }
+
+    u32 first = mcts_pool_alloc(agent->Pool, count);
+    if (first == 0) {
+        return; // Out of nodes, the node stays a leaf and keeps being valued by rollouts.
+    }
+
+    for (u32 i = 0; i < count; i++) {
+        agent->Pool.Nodes[first + i].Move = placements[i];
+    }
+
+    MCTSNode& node = agent->Pool.Nodes[nodeIndex];
+    node.FirstChild = first;
+    node.ChildCount = (u16)count;
+}
+
+static u32 mcts_select_child(MCTSAgent* agent, const MCTSNode& node) {
+    f32 parentVisits = (f32)(node.Visits + node.PendingVisits);
+    f32 logParent = logf(parentVisits > 1.0f ? parentVisits : 1.0f);
+
+    u32 best = node.FirstChild;
+    f32 bestScore = -INFINITY;
+    for (u32 i = 0; i < node.ChildCount; i++) {
+        const MCTSNode& child = agent->Pool.Nodes[node.FirstChild + i];
+        u32 visits = child.Visits + child.PendingVisits;
+        if (visits == 0) {
+            return node.FirstChild + i;
+        }
+
+        // Pending visits count as losses so the rest of the batch looks elsewhere.
+        f32 mean = (child.ValueSum + agent->Config.GameOverValue * child.PendingVisits) / (f32)visits;
+        f32 score = mean + agent->Config.Exploration * sqrtf(logParent / (f32)visits);
+        if (score > bestScore) {
+            bestScore = score;
+            best = node.FirstChild + i;
+        }
+    }
+    return best;
+}
+
+static void mcts_select_leaf(MCTSAgent* agent, const SimState& root, MCTSBatchSlot& slot, u32& seed) {
+    slot.State = root;
+    slot.RootScore = root.Score;
+    slot.PathLength = 0;
+    slot.Path[slot.PathLength++] = 0;
+
+    // The real piece sequence is hidden from the agent, so every leaf gets a fresh future.
+    slot.State.Seed = RandU32(seed);
+
+    u32 nodeIndex = 0;
+    for (u32 depth = 0; depth < MCTS_MAX_TREE_DEPTH; depth++) {
+        MCTSNode& node = agent->Pool.Nodes[nodeIndex];
+        if (node.ChildCount == 0) {
+            if (node.Visits == 0 && depth > 0) {
+                break; // First visit is valued by a rollout before we pay to expand it.
+            }
+            mcts_expand(agent, nodeIndex, slot.State, depth);
+            if (node.ChildCount == 0) {
+                break;
+            }
+        }
+
+        nodeIndex = mcts_select_child(agent, node);
+        sim_apply_placement(slot.State, agent->Pool.Nodes[nodeIndex].Move);
+        slot.Path[slot.PathLength++] = nodeIndex;
+        if (slot.State.IsOver) {
+            break;
+        }
+    }
+
+    for (u32 i = 0; i < slot.PathLength; i++) {
+        agent->Pool.Nodes[slot.Path[i]].PendingVisits++;
+    }
+
+    slot.NeedsRollout = !slot.State.IsOver;
+    slot.Value = agent->Config.GameOverValue;
+    slot.RolloutPieces = 0;
+}
+
+static void mcts_backpropagate(MCTSAgent* agent, const MCTSBatchSlot& slot) {
+    for (u32 i = 0; i < slot.PathLength; i++) {
+        MCTSNode& node = agent->Pool.Nodes[slot.Path[i]];
+        node.PendingVisits--;
+        node.Visits++;
+        node.ValueSum += slot.Value;
+    }
+}
+
+/*
+    Runs the configured number of rollouts from `root` and returns the placement with the best mean value.
+    Returns false if the root has no legal placements.
+*/
+
+bool mcts_search(MCTSAgent* agent, const SimState& root, Placement* result) {
+    if (root.IsOver) {
+        return false;
+    }
+
+    mcts_pool_reset(agent->Pool);
+    mcts_pool_alloc(agent->Pool, 1);
+    mcts_expand(agent, 0, root, 0);
+
+    MCTSNode* nodes = agent->Pool.Nodes;
+    if (nodes[0].ChildCount == 0) {
+        return false;
+    }
+
+    // Selection happens on the calling thread, so it owns stream 0 outside of rollout batches.
+    u32& seed = agent->ThreadSeeds[0].Seed;
+    Utils::Clock clock;
+
+    u32 remaining = agent->Config.Rollouts;
+    while (remaining > 0) {
+        u32 batchSize = remaining < agent->Config.BatchSize ? remaining : agent->Config.BatchSize;
+        for (u32 i = 0; i < batchSize; i++) {
+            mcts_select_leaf(agent, root, agent->Batch[i], seed);
+        }
+
+        clock.Tick();
+        jobs_parallel_for(agent->Jobs, batchSize, mcts_rollout_job, agent);
+        agent->Stats.RolloutSeconds += clock.Tick();
+
+        for (u32 i = 0; i < batchSize; i++) {
+            mcts_backpropagate(agent, agent->Batch[i]);
+            if (agent->Batch[i].NeedsRollout) {
+                agent->Stats.Rollouts++;
+                agent->Stats.RolloutPieces += agent->Batch[i].RolloutPieces;
+            }
+        }
+        remaining -= batchSize;
+    }
+
+    agent->Stats.NodesUsed = agent->Pool.Count;
+
+    // With dozens of root children and a modest budget visit counts stay close together, so the
+    // move is picked on mean value instead of on the most visited child.
+    u32 best = nodes[0].FirstChild;
+    f32 bestMean = -INFINITY;
+    for (u32 i = 0; i < nodes[0].ChildCount; i++) {
+        const MCTSNode& child = nodes[nodes[0].FirstChild + i];
+        if (child.Visits == 0) {
+            continue;
+        }
+        f32 mean = child.ValueSum / (f32)child.Visits;
+        if (mean > bestMean) {
+            bestMean = mean;
+            best = nodes[0].FirstChild + i;
+        }
+    }
+    *result = nodes[best].Move;
+    return true;
+}
@@ -0,0 +1,66 @@
+#pragma once
+
+#include "core/base.h"
+#include "core/sim.hpp"
+#include "core/jobs.hpp"
+#include "bots/evaluator.hpp"
+#include "bots/network.hpp"
+
+/*
+    Monte-Carlo tree search over placements. Only the current and next pieces are known, so the
+    tree is at most two placements deep and everything below it is estimated by rollouts that
+    draw random pieces. Leaves are selected a batch at a time (using virtual loss so a batch
+    spreads over the tree) and the batch of rollouts is fanned out across a JobPool.
+*/
+
+// Both known pieces, after that the piece sequence is hidden from the agent.
+#define MCTS_MAX_TREE_DEPTH 2
+
+enum class MCTSRolloutPolicy {
+    Random,
+    Greedy
+};
+
+struct MCTSConfig {
+    u32 Rollouts = 4096;
+    u32 BatchSize = 64;
+    u32 RolloutDepth = 2;
+    u32 NodeCapacity = 1 << 16;
+    f32 Exploration = 1.0f;
+    f32 GameOverValue = -20.0f; // Live boards are floored above this, see mcts_rollout_job.
+    MCTSRolloutPolicy RolloutPolicy = MCTSRolloutPolicy::Greedy;
+    EvalWeights Weights = evaluator_default_weights();
+    const Network* Net = nullptr; // When set, rollouts and leaf values use the network instead of Weights.
+    u32 Seed = 0;
+};
+
+/*
+    Children of a node are allocated contiguously from the pool, so a node only needs the index
+    of its first child. Index 0 is the root, which can never be anyone's child.
+*/
+
+struct MCTSNode {
+    u32 FirstChild;
+    u16 ChildCount;
+    u16 PendingVisits;
+    Placement Move;
+    u32 Visits;
+    f32 ValueSum;
+};
+
+STATIC_ASSERT(sizeof(MCTSNode) == 20, "Expected MCTSNode to stay compact.");
+
+struct MCTSStats {
+    u64 Rollouts;
+    u64 RolloutPieces;
+    f64 RolloutSeconds;
+    u32 NodesUsed;
+};
+
+struct MCTSAgent;
+
+MCTSAgent* mcts_create(const MCTSConfig& config, JobPool* jobs);
+void mcts_destroy(MCTSAgent* agent);
+
+bool mcts_search(MCTSAgent* agent, const SimState& root, Placement* result);
+MCTSStats mcts_get_stats(MCTSAgent* agent);
@@ -0,0 +1,400 @@
+#include "bots/network.hpp"
+
+#include "maths/random.hpp"
+
+#include <cmath>
+
+#if defined(__x86_64__) || defined(__i386__)
+    #define NETWORK_HAS_X86 1
+    #include <immintrin.h>
+#else
+    #define NETWORK_HAS_X86 0
+#endif
+
+#if defined(__wasm_simd128__)
+    #define NETWORK_HAS_WASM_SIMD 1
+    #include <wasm_simd128.h>
+#else
+    #define NETWORK_HAS_WASM_SIMD 0
+#endif
+
+struct NetworkFileLayer {
+    u32 Inputs;
+    u32 Outputs;
+    f32 Scale;
+};
+
+static constexpr u32 network_align(u32 size) {
+    return (size + NETWORK_ALIGNMENT - 1) / NETWORK_ALIGNMENT * NETWORK_ALIGNMENT;
+}
+
+/*
+    Kernels. Each one dots a single weight row against `count` input rows, so a layer is one
+    call per output neuron with the weights staying hot in cache across the whole batch.
+*/
+
+static void network_matvec_scalar(const u8* inputs, u32 inputStride, u32 count, const i8* weights, u32 length, i32* results) {
+    for (u32 b = 0; b < count; b++) {
+        const u8* x = inputs + b * inputStride;
+        i32 sum = 0;
+        for (u32 i = 0; i < length; i++) {
+            sum += (i32)x[i] * (i32)weights[i];
+        }
+        results[b] = sum;
+    }
+}
+
+#if NETWORK_HAS_X86
+__attribute__((target("avx2")))
+static void network_matvec_avx2(const u8* inputs, u32 inputStride, u32 count, const i8* weights, u32 length, i32* results) {
+    const __m256i ones = _mm256_set1_epi16(1);
+    for (u32 b = 0; b < count; b++) {
+        const u8* x = inputs + b * inputStride;
+        __m256i sum = _mm256_setzero_si256();
+        for (u32 i = 0; i < length; i += 32) {
+            __m256i xv = _mm256_loadu_si256((const __m256i*)(x + i));
+            __m256i wv = _mm256_loadu_si256((const __m256i*)(weights + i));
+            // u8 x i8 pairs into i16 (activations <= 127 keep this from saturating), then into i32.
+            __m256i pairs = _mm256_maddubs_epi16(xv, wv);
+            sum = _mm256_add_epi32(sum, _mm256_madd_epi16(pairs, ones));
+        }
+        __m128i half = _mm_add_epi32(_mm256_castsi256_si128(sum), _mm256_extracti128_si256(sum, 1));
+        half = _mm_hadd_epi32(half, half);
+        half = _mm_hadd_epi32(half, half);
+        results[b] = _mm_cvtsi128_si32(half);
+    }
+}
+#endif
+
+#if NETWORK_HAS_WASM_SIMD
+static void network_matvec_wasm(const u8* inputs, u32 inputStride, u32 count, const i8* weights, u32 length, i32* results) {
+    for (u32 b = 0; b < count; b++) {
+        const u8* x = inputs + b * inputStride;
+        v128_t sum = wasm_i32x4_splat(0);
+        for (u32 i = 0; i < length; i += 16) {
+            v128_t xv = wasm_v128_load(x + i);
+            v128_t wv = wasm_v128_load(weights + i);
+            sum = wasm_i32x4_add(sum, wasm_i32x4_dot_i16x8(wasm_u16x8_extend_low_u8x16(xv), wasm_i16x8_extend_low_i8x16(wv)));
+            sum = wasm_i32x4_add(sum, wasm_i32x4_dot_i16x8(wasm_u16x8_extend_high_u8x16(xv), wasm_i16x8_extend_high_i8x16(wv)));
+        }
+        results[b] = wasm_i32x4_extract_lane(sum, 0) + wasm_i32x4_extract_lane(sum, 1)
+                   + wasm_i32x4_extract_lane(sum, 2) + wasm_i32x4_extract_lane(sum, 3);
+    }
+}
+#endif
+
+NetworkKernel network_best_kernel() {
+#if NETWORK_HAS_WASM_SIMD
+    return NetworkKernel::WasmSIMD;
+#elif NETWORK_HAS_X86
+    return __builtin_cpu_supports("avx2") ? NetworkKernel::AVX2 : NetworkKernel::Scalar;
+#else
+    return NetworkKernel::Scalar;
+#endif
+}
+
+bool network_use_kernel(Network* network, NetworkKernel kernel) {
+    switch (kernel) {
+        case NetworkKernel::Scalar:
+            network->MatVec = network_matvec_scalar;
+            break;
+#if NETWORK_HAS_X86
+        case NetworkKernel::AVX2:
+            if (!__builtin_cpu_supports("avx2")) {
+                return false;
+            }
+            network->MatVec = network_matvec_avx2;
+            break;
+#endif
+#if NETWORK_HAS_WASM_SIMD
+        case NetworkKernel::WasmSIMD:
+            network->MatVec = network_matvec_wasm;
+            break;
+#endif
+        default:
+            return false;
+    }
+    network->Kernel = kernel;
+    return true;
+}
+
+const char* network_kernel_name(NetworkKernel kernel) {
+    switch (kernel) {
+        case NetworkKernel::Scalar: return "scalar";
+        case NetworkKernel::AVX2: return "avx2";
+        case NetworkKernel::WasmSIMD: return "wasm-simd";
+    }
+    return "unknown";
+}
+
+/*
+    Construction
+*/
+
+static bool network_validate_shape(const u32* widths, u32 widthCount) {
+    if (widthCount < 2 || widthCount > NETWORK_MAX_LAYERS + 1) {
+        return false;
+    }
+    if (widths[0] != NETWORK_INPUT_SIZE || widths[widthCount - 1] != 1) {
+        return false;
+    }
+    for (u32 i = 1; i < widthCount; i++) {
+        if (widths[i] == 0 || widths[i] > NETWORK_MAX_WIDTH) {
+            return false;
+        }
+    }
+    return true;
+}
+
+static Network* network_allocate(const u32* widths, u32 widthCount) {
+    Network* network = new Network();
+    network->LayerCount = widthCount - 1;
+    for (u32 i = 0; i < network->LayerCount; i++) {
+        NetworkLayer& layer = network->Layers[i];
+        layer.Inputs = widths[i];
+        layer.Outputs = widths[i + 1];
+        layer.Stride = network_align(layer.Inputs);
+        layer.Scale = 1.0f;
+        layer.Bias = new i32[layer.Outputs]();
+        layer.Weights = new i8[layer.Outputs * layer.Stride]();
+    }
+    network_use_kernel(network, network_best_kernel());
+    return network;
+}
+
+void network_destroy(Network* network) {
+    for (u32 i = 0; i < network->LayerCount; i++) {
+        delete[] network->Layers[i].Bias;
+        delete[] network->Layers[i].Weights;
+    }
+    delete network;
+}
+
+/*
+    Random weights, only useful for benchmarking and for checking the kernels agree.
+*/
+
+Network* network_create_random(const u32* widths, u32 widthCount, u32 seed) {
+    if (!network_validate_shape(widths, widthCount)) {
+        CX_ERROR("Invalid network shape.");
+        return nullptr;
+    }
+
+    Network* network = network_allocate(widths, widthCount);
+    for (u32 i = 0; i < network->LayerCount; i++) {
+        NetworkLayer& layer = network->Layers[i];
+        for (u32 o = 0; o < layer.Outputs; o++) {
+            for (u32 k = 0; k < layer.Inputs; k++) {
+                layer.Weights[o * layer.Stride + k] = (i8)((i32)RandU32(seed, 0, 254) - 127);
+            }
+            layer.Bias[o] = (i32)RandU32(seed, 0, 2000) - 1000;
+        }
+        // Keeps typical activations inside the [0, 127] range rather than saturating.
+        layer.Scale = 4.0f / (127.0f * sqrtf((f32)layer.Inputs));
+    }
+    return network;
+}
+
+/*
+    File layout: magic, version, layer count, then per layer its inputs, outputs and scale,
+    the int32 biases and the int8 weights, row by row and unpadded.
+*/
+
+Network* network_load(const char* path) {
+    FILE* file = fopen(path, "rb");
+    if (!file) {
+        CX_ERROR("Failed to open %s.", path);
+        return nullptr;
+    }
+
+    char magic[8];
+    u32 version = 0;
+    u32 layerCount = 0;
+    bool ok = fread(magic, sizeof(magic), 1, file) == 1
+        && memcmp(magic, NETWORK_MAGIC, sizeof(magic)) == 0
+        && fread(&version, sizeof(version), 1, file) == 1
+        && version == NETWORK_VERSION
+        && fread(&layerCount, sizeof(layerCount), 1, file) == 1
+        && layerCount > 0
+        && layerCount <= NETWORK_MAX_LAYERS;
+
+    NetworkFileLayer fileLayers[NETWORK_MAX_LAYERS];
+    u32 widths[NETWORK_MAX_LAYERS + 1];
+    long dataStart = 0;
+    if (ok) {
+        // Layer headers are interleaved with their data, so walk the file once for the shape.
+        dataStart = ftell(file);
+        for (u32 i = 0; i < layerCount && ok; i++) {
+            ok = fread(&fileLayers[i], sizeof(NetworkFileLayer), 1, file) == 1
+                && fileLayers[i].Outputs <= NETWORK_MAX_WIDTH
+                && fileLayers[i].Inputs <= NETWORK_MAX_WIDTH + NETWORK_INPUT_SIZE
+                && (i == 0 || fileLayers[i].Inputs == fileLayers[i - 1].Outputs);
+            if (ok) {
+                widths[i] = fileLayers[i].Inputs;
+                widths[i + 1] = fileLayers[i].Outputs;
+                u64 skip = sizeof(i32) * fileLayers[i].Outputs + (u64)fileLayers[i].Outputs * fileLayers[i].Inputs;
+                ok = fseek(file, (long)skip, SEEK_CUR) == 0;
+            }
+        }
+        ok = ok && network_validate_shape(widths, layerCount + 1);
+    }
+
+    if (!ok) {
+        CX_ERROR("%s is not a valid network file.", path);
+        fclose(file);
+        return nullptr;
+    }
+
+    Network* network = network_allocate(widths, layerCount + 1);
+    fseek(file, dataStart, SEEK_SET);
+    for (u32 i = 0; i < layerCount && ok; i++) {
+        NetworkLayer& layer = network->Layers[i];
+        ok = fread(&fileLayers[i], sizeof(NetworkFileLayer), 1, file) == 1
+            && fread(layer.Bias, sizeof(i32), layer.Outputs, file) == layer.Outputs;
+        layer.Scale = fileLayers[i].Scale;
+        for (u32 o = 0; o < layer.Outputs && ok; o++) {
+            ok = fread(&layer.Weights[o * layer.Stride], 1, layer.Inputs, file) == layer.Inputs;
+        }
+    }
+    fclose(file);
+
+    if (!ok) {
+        CX_ERROR("%s is truncated.", path);
+        network_destroy(network);
+        return nullptr;
+    }
+    return network;
+}
+
+bool network_save(const Network* network, const char* path) {
+    FILE* file = fopen(path, "wb");
+    if (!file) {
+        CX_ERROR("Failed to open %s for writing.", path);
+        return false;
+    }
+
+    u32 version = NETWORK_VERSION;
+    fwrite(NETWORK_MAGIC, 8, 1, file);
+    fwrite(&version, sizeof(version), 1, file);
+    fwrite(&network->LayerCount, sizeof(network->LayerCount), 1, file);
+    for (u32 i = 0; i < network->LayerCount; i++) {
+        const NetworkLayer& layer = network->Layers[i];
+        NetworkFileLayer fileLayer = { layer.Inputs, layer.Outputs, layer.Scale };
+        fwrite(&fileLayer, sizeof(fileLayer), 1, file);
+        fwrite(layer.Bias, sizeof(i32), layer.Outputs, file);
+        for (u32 o = 0; o < layer.Outputs; o++) {
+            fwrite(&layer.Weights[o * layer.Stride], 1, layer.Inputs, file);
+        }
+    }
+    fclose(file);
+    return true;
+}
+
+/*
+    Inference
+*/
+
+u32 network_input_stride(const Network* network) {
+    return network->Layers[0].Stride;
+}
+
+void network_encode_board(const Network* network, const u16* rows, u32 linesCleared, u8* input) {
+    memset(input, 0, network->Layers[0].Stride);
+    for (u32 row = 0; row < FIELD_HEIGHT; row++) {
+        for (u32 col = 0; col < FIELD_WIDTH; col++) {
+            input[row * FIELD_WIDTH + col] = (u8)((rows[row] >> col) & 1);
+        }
+    }
+    if (linesCleared > 0) {
+        input[FIELD_SIZE + linesCleared - 1] = 1;
+    }
+}
+
+/*
+    Runs `count` encoded boards (rows of network_input_stride bytes) through the network. The
+    intermediate activations live on the stack, so this is safe to call from any thread.
+*/
+
+void network_forward(const Network* network, const u8* inputs, u32 count, f32* outputs) {
+    CX_ASSERT(count <= NETWORK_MAX_BATCH, "Network batch too large!");
+
+    u8 buffers[2][NETWORK_MAX_BATCH * network_align(NETWORK_MAX_WIDTH)];
+    i32 results[NETWORK_MAX_BATCH];
+
+    const u8* in = inputs;
+    u32 inStride = network->Layers[0].Stride;
+    for (u32 l = 0; l < network->LayerCount; l++) {
+        const NetworkLayer& layer = network->Layers[l];
+        bool isLast = l + 1 == network->LayerCount;
+        u8* out = buffers[l & 1];
+        u32 outStride = isLast ? 0 : network->Layers[l + 1].Stride;
+        if (!isLast) {
+            memset(out, 0, count * outStride);
+        }
+
+        for (u32 o = 0; o < layer.Outputs; o++) {
+            network->MatVec(in, inStride, count, &layer.Weights[o * layer.Stride], layer.Stride, results);
+            for (u32 b = 0; b < count; b++) {
+                f32 value = (f32)(results[b] + layer.Bias[o]) * layer.Scale;
+                if (isLast) {
+                    outputs[b] = value;
+                } else {
+                    // ReLU, quantised back to [0, 127].
+                    f32 clamped = value < 0.0f ? 0.0f : (value > 127.0f ? 127.0f : value);
+                    out[b * outStride + o] = (u8)(clamped + 0.5f);
+                }
+            }
+        }
+
+        in = out;
+        inStride = outStride;
+    }
+}
+
+/*
+    Drop-in for evaluator_pick_placement: every candidate board is encoded into one batch and
+    scored with a single forward pass.
+*/
+
+bool network_pick_placement(const Network* network, const SimState& state, bool allowSwap, Placement* result) {
+    Placement placements[SIM_MAX_PLACEMENTS];
+    u32 count = sim_get_placements(state, placements, allowSwap);
+    if (count == 0) {
+        return false;
+    }
+
+    u16 rows[FIELD_HEIGHT];
+    u16 preview[FIELD_HEIGHT];
+    field_to_rows(state.Field, rows);
+
+    u32 stride = network_input_stride(network);
+    u8 inputs[NETWORK_MAX_BATCH * network_align(NETWORK_INPUT_SIZE)];
+    for (u32 i = 0; i < count; i++) {
+        u32 lineCount = sim_preview_placement(state, rows, placements[i], preview);
+        network_encode_board(network, preview, lineCount, &inputs[i * stride]);
+    }
+
+    f32 scores[NETWORK_MAX_BATCH];
+    network_forward(network, inputs, count, scores);
+
+    u32 bestIndex = 0;
+    for (u32 i = 1; i < count; i++) {
+        if (scores[i] > scores[bestIndex]) {
+            bestIndex = i;
+        }
+    }
+    *result = placements[bestIndex];
+    return true;
+}
+
+f32 network_score_field(const Network* network, const u32* field, u32 linesCleared) {
+    u16 rows[FIELD_HEIGHT];
+    field_to_rows(field, rows);
+
+    u8 input[network_align(NETWORK_INPUT_SIZE)];
+    network_encode_board(network, rows, linesCleared, input);
+
+    f32 score;
+    network_forward(network, input, 1, &score);
+    return score;
+}
@@ -0,0 +1,65 @@
+#pragma once
+
+#include "core/base.h"
+#include "core/sim.hpp"
+
+/*
+    Small quantised MLP for scoring boards, an alternative to the hand-written heuristic in
+    evaluator.hpp. Weights are int8 with one float scale per layer, activations are uint8 in
+    [0, 127] (so two products always fit the 16 bit intermediate of AVX2's maddubs), and all of
+    a piece's candidate placements are scored as one batch.
+
+    Input is the board after the placement as one byte per cell (row-major, row 0 first), then
+    a one-hot of the lines the placement cleared. The last layer has a single output, higher is better.
+*/
+
+#define NETWORK_MAGIC "TTRSNNET"
+#define NETWORK_VERSION 1
+
+#define NETWORK_MAX_LAYERS 8
+#define NETWORK_MAX_WIDTH 256
+#define NETWORK_MAX_BATCH SIM_MAX_PLACEMENTS
+#define NETWORK_INPUT_SIZE (FIELD_SIZE + 4)
+
+// Rows of every layer's input are padded with zeros to a multiple of this many bytes.
+#define NETWORK_ALIGNMENT 32
+
+enum class NetworkKernel {
+    Scalar,
+    AVX2,
+    WasmSIMD
+};
+
+typedef void (*NetworkMatVec)(const u8* inputs, u32 inputStride, u32 count, const i8* weights, u32 length, i32* results);
+
+struct NetworkLayer {
+    u32 Inputs;
+    u32 Outputs;
+    u32 Stride; // Inputs rounded up to NETWORK_ALIGNMENT.
+    f32 Scale;  // Accumulator to next layer activation (or to the final output).
+    i32* Bias;
+    i8* Weights; // Outputs rows of Stride bytes.
+};
+
+struct Network {
+    u32 LayerCount;
+    NetworkLayer Layers[NETWORK_MAX_LAYERS];
+    NetworkKernel Kernel;
+    NetworkMatVec MatVec;
+};
+
+Network* network_load(const char* path);
+Network* network_create_random(const u32* widths, u32 widthCount, u32 seed);
+bool network_save(const Network* network, const char* path);
+void network_destroy(Network* network);
+
+NetworkKernel network_best_kernel();
+bool network_use_kernel(Network* network, NetworkKernel kernel);
+const char* network_kernel_name(NetworkKernel kernel);
+
+u32 network_input_stride(const Network* network);
+void network_encode_board(const Network* network, const u16* rows, u32 linesCleared, u8* input);
+void network_forward(const Network* network, const u8* inputs, u32 count, f32* outputs);
+
+bool network_pick_placement(const Network* network, const SimState& state, bool allowSwap, Placement* result);
+f32 network_score_field(const Network* network, const u32* field, u32 linesCleared);
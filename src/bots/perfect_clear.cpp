@@ -0,0 +1,596 @@
+#include "bots/perfect_clear.hpp"
+
+#include "core/utils.hpp"
+
+#include <atomic>
+
+/*
+    Boards are the bottom PC_MAX_HEIGHT rows, FIELD_WIDTH bits per row from row 0 up. Everything
+    above the rows still to be cleared is empty by construction, which is what makes a hard drop
+    landing a simple function of the column heights.
+*/
+
+typedef u64 PCBoard;
+
+#define PC_ROW_MASK ((PCBoard)SIM_FULL_ROW)
+#define PC_NO_PIECE 0
+
+#define PC_MEMO_BITS 19
+#define PC_MEMO_SIZE (1u << PC_MEMO_BITS)
+
+#define PC_BUDGET_BLOCK 256
+
+// Both pieces, every rotation, every column.
+#define PC_MAX_CANDIDATES (2 * SHAPE_ROTATION_COUNT * FIELD_WIDTH)
+
+struct PCShapeInfo {
+    PCBoard Mask;       // Cells with the shape's lowest row and leftmost column at bit 0.
+    i8 Bottom[4];       // Lowest cell of each column the shape covers, relative to Mask.
+    u8 Width;
+    u8 Height;
+    i8 OffsetX;         // Shape box position for a Mask placed at column 0, row 0.
+    i8 OffsetY;
+    bool IsDuplicate;   // Same cells as an earlier rotation (the O piece, for instance).
+};
+
+struct PCShapeTable {
+    PCShapeInfo Info[SHAPE_COUNT][SHAPE_ROTATION_COUNT];
+};
+
+static PCShapeTable pc_build_shape_table() {
+    PCShapeTable table = {};
+    for (u32 id = 1; id < SHAPE_COUNT; id++) {
+        for (u32 r = 0; r < SHAPE_ROTATION_COUNT; r++) {
+            const Shape& shape = shape_get_rotated(id, r);
+            PCShapeInfo& info = table.Info[id][r];
+
+            // Same (row, col) mapping as field_place_shape.
+            i32 minX = 4, minY = 4, maxX = -1, maxY = -1;
+            for (i32 i = 0; i < 4; i++) {
+                for (i32 j = 0; j < 4; j++) {
+                    if (shape.Data[(j * 4) + i]) {
+                        minX = i < minX ? i : minX;
+                        maxX = i > maxX ? i : maxX;
+                        minY = 3 - j < minY ? 3 - j : minY;
+                        maxY = 3 - j > maxY ? 3 - j : maxY;
+                    }
+                }
+            }
+
+            info.Width = (u8)(maxX - minX + 1);
+            info.Height = (u8)(maxY - minY + 1);
+            info.OffsetX = (i8)-minX;
+            info.OffsetY = (i8)-minY;
+            for (i32 i = 0; i < 4; i++) {
+                info.Bottom[i] = -1;
+            }
+            for (i32 i = 0; i < 4; i++) {
+                for (i32 j = 3; j >= 0; j--) {
+                    if (shape.Data[(j * 4) + i]) {
+                        i32 x = i - minX;
+                        i32 y = 3 - j - minY;
+                        info.Mask |= (PCBoard)1 << (y * FIELD_WIDTH + x);
+                        if (info.Bottom[x] < 0) {
+                            info.Bottom[x] = (i8)y;
+                        }
+                    }
+                }
+            }
+
+            for (u32 k = 0; k < r; k++) {
+                if (memcmp(shape.Data, shape_get_rotated(id, k).Data, sizeof(shape.Data)) == 0) {
+                    info.IsDuplicate = true;
+                }
+            }
+        }
+    }
+    return table;
+}
+
+static const PCShapeInfo& pc_get_shape_info(u32 id, u32 rotation) {
+    static const PCShapeTable s_ShapeTable = pc_build_shape_table();
+    return s_ShapeTable.Info[id][rotation];
+}
+
+static u32 pc_row(PCBoard board, u32 row) {
+    return (u32)((board >> (row * FIELD_WIDTH)) & PC_ROW_MASK);
+}
+
+// Removes full rows, shifting everything above down, and returns how many went.
+static u32 pc_clear_lines(PCBoard& board, u32 height) {
+    u32 cleared = 0;
+    for (u32 row = height; row-- > 0;) {
+        if (pc_row(board, row) == SIM_FULL_ROW) {
+            PCBoard below = board & (((PCBoard)1 << (row * FIELD_WIDTH)) - 1);
+            PCBoard above = (board >> ((row + 1) * FIELD_WIDTH)) << (row * FIELD_WIDTH);
+            board = below | above;
+            cleared++;
+        }
+    }
+    return cleared;
+}
+
+static void pc_column_heights(PCBoard board, u32 height, i32* heights) {
+    for (u32 col = 0; col < FIELD_WIDTH; col++) {
+        heights[col] = 0;
+        for (u32 row = height; row-- > 0;) {
+            if ((board >> (row * FIELD_WIDTH + col)) & 1) {
+                heights[col] = (i32)row + 1;
+                break;
+            }
+        }
+    }
+}
+
+// Hard drop landing row of the shape's lowest cell. Nothing sits above the stack, so no stepping is needed.
+static i32 pc_drop(const PCShapeInfo& info, const i32* heights, u32 x) {
+    i32 y = 0;
+    for (u32 i = 0; i < info.Width; i++) {
+        i32 landing = heights[x + i] - info.Bottom[i];
+        y = landing > y ? landing : y;
+    }
+    return y;
+}
+
+/*
+    Cheap dead-end test: columns that are already full from the floor to the clear height split
+    the board into independent wells, and a well can only be filled by whole pieces if its empty
+    cell count is a multiple of four.
+*/
+
+static bool pc_has_dead_well(PCBoard board, u32 height) {
+    u32 fullColumns = SIM_FULL_ROW;
+    u32 rows[PC_MAX_HEIGHT];
+    for (u32 row = 0; row < height; row++) {
+        rows[row] = pc_row(board, row);
+        fullColumns &= rows[row];
+    }
+
+    u32 wellMask = 0;
+    for (u32 col = 0; col <= FIELD_WIDTH; col++) {
+        bool isWall = col == FIELD_WIDTH || (fullColumns >> col) & 1;
+        if (!isWall) {
+            wellMask |= 1u << col;
+            continue;
+        }
+        if (wellMask) {
+            u32 empty = 0;
+            for (u32 row = 0; row < height; row++) {
+                empty += __builtin_popcount(~rows[row] & wellMask);
+            }
+            if (empty % 4 != 0) {
+                return true;
+            }
+            wellMask = 0;
+        }
+    }
+    return false;
+}
+
+// Empty cells with a block somewhere above them can only be filled once the rows over them clear.
+static bool pc_has_covered_cell(PCBoard board, u32 height) {
+    PCBoard above = 0;
+    for (u32 row = 1; row < height; row++) {
+        above |= board >> (row * FIELD_WIDTH);
+    }
+    return (above & ~board) != 0;
+}
+
+/*
+    Memo of states proven to have no solution, shared by every thread since that only depends on
+    the state. Direct mapped and lossy, so a collision only costs a re-search.
+
+    Whether a state is dead also depends on the queue and on the pass (a hole-free failure proves
+    nothing for the full search), so every pc_solve_height call gets a salt made from a 32 bit
+    generation and the queue's pieces. Keys are a 64 bit fingerprint of the state and salt, so
+    nothing needs clearing between solves and stale entries only match by a 2^-64 accident. The
+    memo is still cleared when the generation wraps. Keys are never 0, which marks empty slots.
+*/
+
+static u64 pc_mix(u64 value) {
+    value ^= value >> 30;
+    value *= 0xbf58476d1ce4e5b9ull;
+    value ^= value >> 27;
+    value *= 0x94d049bb133111ebull;
+    value ^= value >> 31;
+    return value;
+}
+
+static u64 pc_memo_salt(u32 generation, const u32* pieces, u32 pieceCount) {
+    u64 salt = pc_mix(((u64)generation << 32) | pieceCount);
+    for (u32 i = 0; i < pieceCount; i++) {
+        salt = pc_mix(salt ^ pieces[i]);
+    }
+    return salt;
+}
+
+static u64 pc_memo_key(PCBoard board, u32 height, u32 currentID, u32 pieceIndex, u64 salt) {
+    u64 state = board | ((u64)height << 40) | ((u64)currentID << 43) | ((u64)pieceIndex << 46);
+    return pc_mix(pc_mix(state) ^ salt) | 1;
+}
+
+static u32 pc_memo_slot(u64 key) {
+    return (u32)(key >> 32) & (PC_MEMO_SIZE - 1);
+}
+
+struct PCSolver {
+    PCConfig Config;
+    JobPool* Jobs;
+    std::atomic<u64>* Memo;
+    u32 Generation;
+    PCStats Stats;
+};
+
+static void pc_memo_clear(PCSolver* solver) {
+    for (u32 i = 0; i < PC_MEMO_SIZE; i++) {
+        solver->Memo[i].store(0, std::memory_order_relaxed);
+    }
+}
+
+PCSolver* pc_create(const PCConfig& config, JobPool* jobs) {
+    PCSolver* solver = new PCSolver();
+    solver->Config = config;
+    solver->Jobs = jobs;
+    solver->Memo = new std::atomic<u64>[PC_MEMO_SIZE];
+    pc_memo_clear(solver);
+    solver->Generation = 0;
+    solver->Stats = {};
+    return solver;
+}
+
+void pc_destroy(PCSolver* solver) {
+    delete[] solver->Memo;
+    delete solver;
+}
+
+PCStats pc_get_stats(PCSolver* solver) {
+    return solver->Stats;
+}
+
+/*
+    Search
+*/
+
+enum class PCResult {
+    Failed,
+    Solved,
+    Aborted
+};
+
+struct PCCandidate {
+    PCBoard Board;
+    u8 Height;
+    Placement Move;
+};
+
+struct PCSearch {
+    const u32* Pieces; // Current piece followed by the queue.
+    u32 PieceCount;
+    bool AllowSwap;
+    bool HoleFree;
+    u64 MemoSalt;
+    std::atomic<u64>* Memo;
+    std::atomic<i64>* Budget;
+    u32 Depth;
+    Placement Moves[PC_MAX_MOVES];
+    u64 Nodes;
+    u64 MemoHits;
+    const std::atomic<u32>* FirstSolved; // Root move index of the earliest solution so far.
+    u32 RootIndex;
+};
+
+// Every landing of one piece that stays inside the rows being cleared.
+static void pc_add_candidates(PCBoard board, u32 height, const i32* heights, u32 id, bool swap, PCCandidate* candidates, u32& count) {
+    for (u32 r = 0; r < SHAPE_ROTATION_COUNT; r++) {
+        const PCShapeInfo& info = pc_get_shape_info(id, r);
+        if (info.IsDuplicate || info.Height > height) {
+            continue;
+        }
+
+        for (u32 x = 0; x + info.Width <= FIELD_WIDTH; x++) {
+            i32 y = pc_drop(info, heights, x);
+            if (y + info.Height > (i32)height) {
+                continue;
+            }
+
+            PCCandidate& candidate = candidates[count++];
+            candidate.Board = board | (info.Mask << (y * FIELD_WIDTH + x));
+            candidate.Height = (u8)(height - pc_clear_lines(candidate.Board, height));
+            candidate.Move.X = (i8)(x + info.OffsetX);
+            candidate.Move.Y = (i8)(y + info.OffsetY);
+            candidate.Move.Rotation = (u8)r;
+            candidate.Move.Swap = swap;
+        }
+    }
+}
+
+// Lists the moves out of a state, the current piece's first.
+
+static u32 pc_get_candidates(const PCSearch& search, PCBoard board, u32 height, u32 currentID, u32 pieceIndex, PCCandidate* candidates) {
+    i32 heights[FIELD_WIDTH];
+    pc_column_heights(board, height, heights);
+
+    u32 count = 0;
+    u32 nextID = pieceIndex < search.PieceCount ? search.Pieces[pieceIndex] : PC_NO_PIECE;
+    if (currentID != PC_NO_PIECE) {
+        pc_add_candidates(board, height, heights, currentID, false, candidates, count);
+    }
+    // Swapping places the next piece and keeps the current one, as sim_apply_placement does.
+    if (search.AllowSwap && nextID != PC_NO_PIECE && nextID != currentID) {
+        pc_add_candidates(board, height, heights, nextID, true, candidates, count);
+    }
+    return count;
+}
+
+static PCResult pc_search(PCSearch& search, PCBoard board, u32 height, u32 currentID, u32 pieceIndex) {
+    // Another thread already solved it from an earlier root move, which wins regardless.
+    if (search.FirstSolved->load(std::memory_order_relaxed) < search.RootIndex) {
+        return PCResult::Aborted;
+    }
+    // Nodes are taken from the shared budget in blocks so it is only written now and then.
+    if (search.Budget->load(std::memory_order_relaxed) <= 0) {
+        return PCResult::Aborted;
+    }
+    if ((++search.Nodes & (PC_BUDGET_BLOCK - 1)) == 0) {
+        search.Budget->fetch_sub(PC_BUDGET_BLOCK, std::memory_order_relaxed);
+    }
+
+    u32 available = (currentID != PC_NO_PIECE) + (search.PieceCount - pieceIndex);
+    u32 needed = (height * FIELD_WIDTH - __builtin_popcountll(board)) / 4;
+    if (needed > available || search.Depth + needed > PC_MAX_MOVES || pc_has_dead_well(board, height)) {
+        return PCResult::Failed;
+    }
+    if (search.HoleFree && pc_has_covered_cell(board, height)) {
+        return PCResult::Failed;
+    }
+
+    u64 key = pc_memo_key(board, height, currentID, pieceIndex, search.MemoSalt);
+    std::atomic<u64>& slot = search.Memo[pc_memo_slot(key)];
+    if (slot.load(std::memory_order_relaxed) == key) {
+        search.MemoHits++;
+        return PCResult::Failed;
+    }
+
+    PCCandidate candidates[PC_MAX_CANDIDATES];
+    u32 count = pc_get_candidates(search, board, height, currentID, pieceIndex, candidates);
+    u32 nextID = pieceIndex < search.PieceCount ? search.Pieces[pieceIndex] : PC_NO_PIECE;
+
+    bool aborted = false;
+    for (u32 i = 0; i < count; i++) {
+        const PCCandidate& candidate = candidates[i];
+        search.Moves[search.Depth++] = candidate.Move;
+
+        PCResult result = candidate.Board == 0
+            ? PCResult::Solved
+            : pc_search(search, candidate.Board, candidate.Height, candidate.Move.Swap ? currentID : nextID, pieceIndex + 1);
+
+        // A solution leaves its moves in place for the caller to copy out.
+        if (result == PCResult::Solved) {
+            return result;
+        }
+        search.Depth--;
+        aborted |= result == PCResult::Aborted;
+    }
+
+    // Only a fully explored subtree proves anything.
+    if (aborted) {
+        return PCResult::Aborted;
+    }
+    slot.store(key, std::memory_order_relaxed);
+    return PCResult::Failed;
+}
+
+/*
+    Root split. The first piece's moves are handed to the job pool one each; the lowest indexed
+    root move with a solution wins, so results don't depend on thread timing, and jobs for later
+    root moves give up as soon as an earlier one succeeds.
+*/
+
+struct PCRootJob {
+    PCSolver* Solver;
+    const u32* Pieces;
+    u32 PieceCount;
+    bool AllowSwap;
+    u32 CurrentIDs[PC_MAX_CANDIDATES]; // Current piece after each root move.
+    PCCandidate Roots[PC_MAX_CANDIDATES];
+    PCSolution Solutions[PC_MAX_CANDIDATES];
+    bool HoleFree;
+    u64 MemoSalt;
+    std::atomic<i64> Budget;
+    std::atomic<u32> FirstSolved;
+    std::atomic<bool> IsExhausted;
+    std::atomic<u64> Nodes;
+    std::atomic<u64> MemoHits;
+};
+
+static void pc_root_job(void* userData, u32 index, u32 /* threadIndex */) {
+    PCRootJob* job = (PCRootJob*)userData;
+    const PCCandidate& root = job->Roots[index];
+
+    PCSearch search;
+    search.Pieces = job->Pieces;
+    search.PieceCount = job->PieceCount;
+    search.AllowSwap = job->AllowSwap;
+    search.HoleFree = job->HoleFree;
+    search.MemoSalt = job->MemoSalt;
+    search.Memo = job->Solver->Memo;
+    search.Budget = &job->Budget;
+    search.Depth = 1;
+    search.Moves[0] = root.Move;
+    search.Nodes = 0;
+    search.MemoHits = 0;
+    search.FirstSolved = &job->FirstSolved;
+    search.RootIndex = index;
+
+    PCResult result = root.Board == 0
+        ? PCResult::Solved
+        : job->Budget.load() <= 0
+        ? PCResult::Aborted
+        : pc_search(search, root.Board, root.Height, job->CurrentIDs[index], 2);
+
+    if (result == PCResult::Aborted && job->Budget.load() <= 0) {
+        job->IsExhausted = true;
+    }
+    if (result == PCResult::Solved) {
+        PCSolution& solution = job->Solutions[index];
+        memcpy(solution.Moves, search.Moves, sizeof(Placement) * search.Depth);
+        solution.MoveCount = search.Depth;
+
+        u32 first = job->FirstSolved.load();
+        while (index < first && !job->FirstSolved.compare_exchange_weak(first, index)) {}
+    }
+    job->Nodes += search.Nodes;
+    job->MemoHits += search.MemoHits;
+}
+
+static PCOutcome pc_solve_height(PCSolver* solver, PCBoard board, u32 height, const u32* pieces, u32 pieceCount, bool allowSwap, bool holeFree, i64& budget, PCSolution* solution) {
+    PCRootJob* job = new PCRootJob();
+    job->Solver = solver;
+    job->Pieces = pieces;
+    job->PieceCount = pieceCount;
+    job->AllowSwap = allowSwap;
+    job->HoleFree = holeFree;
+    job->Budget = budget;
+    job->FirstSolved = UINT32_MAX;
+    job->IsExhausted = false;
+    job->Nodes = 0;
+    job->MemoHits = 0;
+
+    PCSearch search = {};
+    search.Pieces = pieces;
+    search.PieceCount = pieceCount;
+    search.AllowSwap = allowSwap;
+    u32 count = pc_get_candidates(search, board, height, pieces[0], 1, job->Roots);
+    for (u32 i = 0; i < count; i++) {
+        job->CurrentIDs[i] = job->Roots[i].Move.Swap ? pieces[0] : (pieceCount > 1 ? pieces[1] : PC_NO_PIECE);
+    }
+
+    // Failures under the hole-free restriction prove nothing about the full search, so each
+    // pass gets its own memo generation.
+    solver->Generation++;
+    if (solver->Generation == 0) {
+        pc_memo_clear(solver);
+    }
+    job->MemoSalt = pc_memo_salt(solver->Generation, pieces, pieceCount);
+    jobs_parallel_for(solver->Jobs, count, pc_root_job, job);
+
+    solver->Stats.Nodes += job->Nodes;
+    solver->Stats.MemoHits += job->MemoHits;
+    budget = job->Budget;
+
+    PCOutcome outcome = job->IsExhausted ? PCOutcome::OutOfBudget : PCOutcome::Impossible;
+    u32 first = job->FirstSolved;
+    if (first != UINT32_MAX) {
+        *solution = job->Solutions[first];
+        outcome = PCOutcome::Solved;
+    }
+    delete job;
+    return outcome;
+}
+
+PCOutcome pc_solve(PCSolver* solver, const u32* field, u32 currentID, const u32* queue, u32 queueLength, bool allowSwap, PCSolution* solution) {
+    CX_ASSERT(queueLength <= PC_MAX_QUEUE, "Perfect-clear queue too long!");
+
+    Utils::Clock timer;
+    solver->Stats.Solves++;
+
+    u32 pieces[PC_MAX_QUEUE + 1];
+    pieces[0] = currentID;
+    memcpy(&pieces[1], queue, sizeof(u32) * queueLength);
+    u32 pieceCount = queueLength + 1;
+
+    u16 rows[FIELD_HEIGHT];
+    field_to_rows(field, rows);
+
+    PCBoard board = 0;
+    u32 filledRows = 0;
+    bool isTooHigh = false;
+    for (u32 row = 0; row < FIELD_HEIGHT; row++) {
+        if (rows[row] == 0) {
+            continue;
+        }
+        isTooHigh |= row >= PC_MAX_HEIGHT;
+        board |= (PCBoard)rows[row] << (row * FIELD_WIDTH);
+        filledRows = row + 1;
+    }
+
+    PCOutcome outcome = PCOutcome::Impossible;
+    i64 budget = (i64)solver->Config.MaxNodes;
+    u32 cells = __builtin_popcountll(board);
+    for (u32 pass = solver->Config.HoleFreeFirst ? 0 : 1; pass < 2 && !isTooHigh; pass++) {
+        // Try the lowest clear height the cell count allows first, since it needs the fewest pieces.
+        bool isExhausted = false;
+        for (u32 height = filledRows > 0 ? filledRows : 1; height <= PC_MAX_HEIGHT && outcome != PCOutcome::Solved; height++) {
+            u32 empty = height * FIELD_WIDTH - cells;
+            if (empty == 0 || empty % 4 != 0 || empty / 4 > pieceCount) {
+                continue;
+            }
+            PCOutcome result = pc_solve_height(solver, board, height, pieces, pieceCount, allowSwap, pass == 0, budget, solution);
+            outcome = result == PCOutcome::Solved ? result : outcome;
+            isExhausted |= result == PCOutcome::OutOfBudget;
+        }
+        if (outcome == PCOutcome::Solved) {
+            break;
+        }
+        // A failed hole-free pass proves nothing, only the full one can show there is no solution.
+        if (pass == 1) {
+            outcome = isExhausted ? PCOutcome::OutOfBudget : PCOutcome::Impossible;
+        }
+    }
+
+    switch (outcome) {
+        case PCOutcome::Solved: solver->Stats.Solved++; break;
+        case PCOutcome::Impossible: solver->Stats.Impossible++; break;
+        case PCOutcome::OutOfBudget: solver->Stats.OutOfBudget++; break;
+    }
+    solver->Stats.Seconds += timer.Tick();
+    return outcome;
+}
+
+/*
+    Replays a solution through the regular field functions, as the game would, to check it.
+*/
+
+bool pc_verify(const u32* field, u32 currentID, const u32* queue, u32 queueLength, const PCSolution& solution) {
+    u32 work[FIELD_SIZE];
+    memcpy(work, field, sizeof(work));
+
+    u32 queueIndex = 0;
+    for (u32 i = 0; i < solution.MoveCount; i++) {
+        const Placement& move = solution.Moves[i];
+        u32 nextID = queueIndex < queueLength ? queue[queueIndex] : PC_NO_PIECE;
+        u32 id = currentID;
+        if (move.Swap) {
+            if (nextID == PC_NO_PIECE) {
+                return false;
+            }
+            id = nextID;
+            nextID = currentID;
+        }
+        if (id == PC_NO_PIECE) {
+            return false;
+        }
+
+        // Must be where a hard drop from the spawn height ends up.
+        const Shape& shape = shape_get_rotated(id, move.Rotation);
+        i32 y = SIM_SPAWN_Y;
+        while (y > move.Y && !field_check_collision(work, shape, move.X, y - 1)) {
+            y--;
+        }
+        if (y != move.Y || field_check_collision(work, shape, move.X, y) || !field_check_collision(work, shape, move.X, y - 1)) {
+            return false;
+        }
+        field_place_shape(work, shape, move.X, move.Y);
+        field_clear_lines(work, nullptr);
+
+        currentID = nextID;
+        queueIndex++;
+    }
+
+    for (u32 i = 0; i < FIELD_SIZE; i++) {
+        if (work[i]) {
+            return false;
+        }
+    }
+    return true;
+}
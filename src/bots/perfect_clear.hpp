@@ -0,0 +1,57 @@
+#pragma once
+
+#include "core/base.h"
+#include "core/sim.hpp"
+#include "core/jobs.hpp"
+
+/*
+    Perfect-clear solver. Given a field whose blocks all sit in the bottom four rows and a known
+    piece queue, finds placements (reachable the same way sim_get_placements' are) that leave the
+    field completely empty. The search is a depth-first walk over the bottom rows packed into one
+    u64, remembering states already proven hopeless, with the moves of the first piece split
+    across a JobPool.
+
+    Most solutions never cover an empty cell, so a search restricted to boards without covered
+    cells runs first and is usually all that is needed; the full search only follows if that
+    fails. Both share a node budget, which is what bounds the time to an answer.
+*/
+
+#define PC_MAX_HEIGHT 4
+#define PC_MAX_QUEUE 16
+#define PC_MAX_MOVES (PC_MAX_HEIGHT * FIELD_WIDTH / 4)
+
+enum class PCOutcome {
+    Solved,
+    Impossible,
+    OutOfBudget
+};
+
+struct PCConfig {
+    u64 MaxNodes = 1 << 15;
+    bool HoleFreeFirst = true;
+};
+
+struct PCSolution {
+    Placement Moves[PC_MAX_MOVES];
+    u32 MoveCount;
+};
+
+struct PCStats {
+    u64 Solves;
+    u64 Solved;
+    u64 Impossible;
+    u64 OutOfBudget;
+    u64 Nodes;
+    u64 MemoHits;
+    f64 Seconds;
+};
+
+struct PCSolver;
+
+PCSolver* pc_create(const PCConfig& config, JobPool* jobs);
+void pc_destroy(PCSolver* solver);
+
+// `queue` holds the pieces after `currentID`, so queue[0] is what the game calls the next piece.
+PCOutcome pc_solve(PCSolver* solver, const u32* field, u32 currentID, const u32* queue, u32 queueLength, bool allowSwap, PCSolution* solution);
+bool pc_verify(const u32* field, u32 currentID, const u32* queue, u32 queueLength, const PCSolution& solution);
+PCStats pc_get_stats(PCSolver* solver);
@@ -0,0 +1,97 @@
+#include "bots/rating.hpp"
+
+#include "maths/numerics.hpp"
+
+#include <cmath>
+
+f64 rating_elo_expected(f64 rating, f64 opponentRating) {
+    return 1.0 / (1.0 + pow(10.0, (opponentRating - rating) / 400.0));
+}
+
+void rating_elo_update(f64& ratingA, f64& ratingB, f64 scoreA, f64 k) {
+    f64 expectedA = rating_elo_expected(ratingA, ratingB);
+    ratingA += k * (scoreA - expectedA);
+    ratingB += k * ((1.0 - scoreA) - (1.0 - expectedA));
+}
+
+/*
+    Glicko-2, following Glickman's "Example of the Glicko-2 system": ratings move to the Glicko-2
+    scale, the new volatility is found with the Illinois variant of regula falsi, and the results
+    are scaled back. A player with no games in the period only grows less certain.
+*/
+
+#define GLICKO_SCALE 173.7178
+#define GLICKO_EPSILON 0.000001
+
+static f64 glicko_g(f64 phi) {
+    return 1.0 / sqrt(1.0 + 3.0 * phi * phi / (PI * PI));
+}
+
+GlickoRating rating_glicko_update(const GlickoRating& player, const GlickoGame* games, u32 gameCount, f64 tau) {
+    f64 mu = (player.Rating - RATING_INITIAL) / GLICKO_SCALE;
+    f64 phi = player.Deviation / GLICKO_SCALE;
+    f64 sigma = player.Volatility;
+
+    GlickoRating result = player;
+    if (gameCount == 0) {
+        result.Deviation = sqrt(phi * phi + sigma * sigma) * GLICKO_SCALE;
+        return result;
+    }
+
+    f64 inverseV = 0.0;
+    f64 improvement = 0.0;
+    for (u32 i = 0; i < gameCount; i++) {
+        f64 opponentMu = (games[i].OpponentRating - RATING_INITIAL) / GLICKO_SCALE;
+        f64 g = glicko_g(games[i].OpponentDeviation / GLICKO_SCALE);
+        f64 expected = 1.0 / (1.0 + exp(-g * (mu - opponentMu)));
+        inverseV += g * g * expected * (1.0 - expected);
+        improvement += g * (games[i].Score - expected);
+    }
+    f64 v = 1.0 / inverseV;
+    f64 delta = v * improvement;
+
+    // Solve for the new volatility.
+    f64 a = log(sigma * sigma);
+    auto f = [&](f64 x) {
+        f64 ex = exp(x);
+        f64 d = phi * phi + v + ex;
+        return ex * (delta * delta - phi * phi - v - ex) / (2.0 * d * d) - (x - a) / (tau * tau);
+    };
+
+    f64 A = a;
+    f64 B;
+    if (delta * delta > phi * phi + v) {
+        B = log(delta * delta - phi * phi - v);
+    } else {
+        u32 k = 1;
+        while (f(a - k * tau) < 0.0) {
+            k++;
+        }
+        B = a - k * tau;
+    }
+
+    f64 fA = f(A);
+    f64 fB = f(B);
+    while (fabs(B - A) > GLICKO_EPSILON) {
+        f64 C = A + (A - B) * fA / (fB - fA);
+        f64 fC = f(C);
+        if (fC * fB <= 0.0) {
+            A = B;
+            fA = fB;
+        } else {
+            fA /= 2.0;
+        }
+        B = C;
+        fB = fC;
+    }
+    f64 newSigma = exp(A / 2.0);
+
+    f64 phiStar = sqrt(phi * phi + newSigma * newSigma);
+    f64 newPhi = 1.0 / sqrt(1.0 / (phiStar * phiStar) + 1.0 / v);
+    f64 newMu = mu + newPhi * newPhi * improvement;
+
+    result.Rating = newMu * GLICKO_SCALE + RATING_INITIAL;
+    result.Deviation = newPhi * GLICKO_SCALE;
+    result.Volatility = newSigma;
+    return result;
+}
@@ -0,0 +1,32 @@
+#pragma once
+
+#include "core/base.h"
+
+/*
+    Player ratings from match results, where a score is 1 for a win, 0.5 for a draw and 0 for a
+    loss. Elo is updated after every game. Glicko-2 works in rating periods, updating each
+    player once from all their games in the period, and tracks how uncertain a rating still is.
+*/
+
+#define RATING_INITIAL 1500.0
+#define ELO_K_FACTOR 16.0
+
+f64 rating_elo_expected(f64 rating, f64 opponentRating);
+void rating_elo_update(f64& ratingA, f64& ratingB, f64 scoreA, f64 k = ELO_K_FACTOR);
+
+struct GlickoRating {
+    f64 Rating = RATING_INITIAL;
+    f64 Deviation = 350.0;
+    f64 Volatility = 0.06;
+};
+
+struct GlickoGame {
+    f64 OpponentRating;
+    f64 OpponentDeviation;
+    f64 Score;
+};
+
+// How much volatility may change between periods, 0.3 to 1.2 is sensible.
+#define GLICKO_TAU 0.5
+
+GlickoRating rating_glicko_update(const GlickoRating& player, const GlickoGame* games, u32 gameCount, f64 tau = GLICKO_TAU);
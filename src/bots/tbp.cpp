@@ -0,0 +1,277 @@
+#include "bots/tbp.hpp"
+
+static const char s_PieceChars[SHAPE_COUNT] = { '?', 'I', 'O', 'J', 'L', 'T', 'S', 'Z' };
+
+static const char* s_OrientationNames[4] = { "north", "east", "south", "west" };
+
+/*
+    Cell offsets from the piece centre for each TBP piece in its north orientation (y up). The
+    other orientations are clockwise quarter turns about the centre, (x, y) -> (y, -x).
+*/
+
+struct TBPPieceCells {
+    char Piece;
+    i32 Offsets[4][2];
+};
+
+static const TBPPieceCells s_PieceCells[7] = {
+    { 'I', { {-1, 0}, {0, 0}, {1, 0}, {2, 0} } },
+    { 'O', { {0, 0}, {1, 0}, {0, 1}, {1, 1} } },
+    { 'T', { {-1, 0}, {0, 0}, {1, 0}, {0, 1} } },
+    { 'L', { {-1, 0}, {0, 0}, {1, 0}, {1, 1} } },
+    { 'J', { {-1, 0}, {0, 0}, {1, 0}, {-1, 1} } },
+    { 'S', { {-1, 0}, {0, 0}, {0, 1}, {1, 1} } },
+    { 'Z', { {-1, 1}, {0, 1}, {0, 0}, {1, 0} } },
+};
+
+char tbp_piece_from_shape(u32 shapeID) {
+    return s_PieceChars[shapeID];
+}
+
+void tbp_init(TBPConnection& connection, FILE* in, FILE* out) {
+    connection.In = in;
+    connection.Out = out;
+    connection.ReadBuffer[0] = '\0';
+    connection.WriteLength = 0;
+}
+
+/*
+    Minimal in-place JSON scanning. Bot messages are small flat objects, so finding a key is
+    just a search for its quoted name followed by a colon.
+*/
+
+static const char* tbp_find_value(const char* json, const char* key) {
+    u32 keyLength = (u32)strlen(key);
+    for (const char* p = strchr(json, '"'); p; p = strchr(p + 1, '"')) {
+        if (strncmp(p + 1, key, keyLength) == 0 && p[keyLength + 1] == '"') {
+            const char* value = p + keyLength + 2;
+            while (*value == ' ' || *value == ':') {
+                value++;
+            }
+            return value;
+        }
+    }
+    return nullptr;
+}
+
+static bool tbp_string_equals(const char* value, const char* expected) {
+    if (!value || *value != '"') {
+        return false;
+    }
+    u32 length = (u32)strlen(expected);
+    return strncmp(value + 1, expected, length) == 0 && value[length + 1] == '"';
+}
+
+TBPMessageType tbp_read_message(TBPConnection& connection) {
+    if (!fgets(connection.ReadBuffer, TBP_MAX_MESSAGE, connection.In)) {
+        connection.ReadBuffer[0] = '\0';
+        return TBPMessageType::Unknown;
+    }
+
+    const char* type = tbp_find_value(connection.ReadBuffer, "type");
+    if (tbp_string_equals(type, "info")) return TBPMessageType::Info;
+    if (tbp_string_equals(type, "ready")) return TBPMessageType::Ready;
+    if (tbp_string_equals(type, "error")) return TBPMessageType::Error;
+    if (tbp_string_equals(type, "suggestion")) return TBPMessageType::Suggestion;
+    return TBPMessageType::Unknown;
+}
+
+/*
+    Pulls up to maxMoves locations out of a suggestion, in the bot's order of preference.
+*/
+
+u32 tbp_parse_suggestion(const TBPConnection& connection, TBPMove* moves, u32 maxMoves) {
+    u32 count = 0;
+    const char* cursor = connection.ReadBuffer;
+    while (count < maxMoves && (cursor = tbp_find_value(cursor, "location"))) {
+        const char* end = strchr(cursor, '}');
+        const char* type = tbp_find_value(cursor, "type");
+        const char* orientation = tbp_find_value(cursor, "orientation");
+        const char* x = tbp_find_value(cursor, "x");
+        const char* y = tbp_find_value(cursor, "y");
+        if (!end || !type || !orientation || !x || !y || type > end || orientation > end || x > end || y > end) {
+            break;
+        }
+
+        TBPMove& move = moves[count];
+        move.Piece = type[0] == '"' ? type[1] : '?';
+        move.Orientation = 0;
+        for (u8 i = 0; i < 4; i++) {
+            if (tbp_string_equals(orientation, s_OrientationNames[i])) {
+                move.Orientation = i;
+            }
+        }
+        move.X = atoi(x);
+        move.Y = atoi(y);
+        count++;
+        cursor = end;
+    }
+    return count;
+}
+
+/*
+    Writing. Messages are assembled in the connection's write buffer and flushed as one line.
+*/
+
+static void tbp_write(TBPConnection& connection, const char* text) {
+    u32 length = (u32)strlen(text);
+    CX_ASSERT(connection.WriteLength + length < TBP_MAX_MESSAGE, "TBP message too long!");
+    memcpy(connection.WriteBuffer + connection.WriteLength, text, length);
+    connection.WriteLength += length;
+}
+
+static void tbp_write_char(TBPConnection& connection, char c) {
+    CX_ASSERT(connection.WriteLength + 1 < TBP_MAX_MESSAGE, "TBP message too long!");
+    connection.WriteBuffer[connection.WriteLength++] = c;
+}
+
+static void tbp_write_i32(TBPConnection& connection, i32 value) {
+    char digits[16];
+    snprintf(digits, sizeof(digits), "%d", value);
+    tbp_write(connection, digits);
+}
+
+static void tbp_write_piece(TBPConnection& connection, char piece) {
+    tbp_write_char(connection, '"');
+    tbp_write_char(connection, piece);
+    tbp_write_char(connection, '"');
+}
+
+static void tbp_flush(TBPConnection& connection) {
+    tbp_write_char(connection, '\n');
+    fwrite(connection.WriteBuffer, 1, connection.WriteLength, connection.Out);
+    fflush(connection.Out);
+    connection.WriteLength = 0;
+}
+
+void tbp_send_rules(TBPConnection& connection) {
+    tbp_write(connection, "{\"type\":\"rules\"}");
+    tbp_flush(connection);
+}
+
+void tbp_send_start(TBPConnection& connection, const SimState& state) {
+    tbp_write(connection, "{\"type\":\"start\",\"hold\":null,\"queue\":[");
+    tbp_write_piece(connection, tbp_piece_from_shape(state.CurrentID));
+    tbp_write_char(connection, ',');
+    tbp_write_piece(connection, tbp_piece_from_shape(state.NextID));
+    tbp_write(connection, "],\"combo\":0,\"back_to_back\":false,\"board\":[");
+    for (i32 row = 0; row < TBP_BOARD_HEIGHT; row++) {
+        if (row) {
+            tbp_write_char(connection, ',');
+        }
+        tbp_write_char(connection, '[');
+        for (i32 col = 0; col < FIELD_WIDTH; col++) {
+            if (col) {
+                tbp_write_char(connection, ',');
+            }
+            u32 cell = row < FIELD_HEIGHT ? state.Field[row * FIELD_WIDTH + col] : 0;
+            if (cell) {
+                tbp_write_piece(connection, tbp_piece_from_shape(cell));
+            } else {
+                tbp_write(connection, "null");
+            }
+        }
+        tbp_write_char(connection, ']');
+    }
+    tbp_write(connection, "]}");
+    tbp_flush(connection);
+}
+
+void tbp_send_suggest(TBPConnection& connection) {
+    tbp_write(connection, "{\"type\":\"suggest\"}");
+    tbp_flush(connection);
+}
+
+void tbp_send_play(TBPConnection& connection, const TBPMove& move) {
+    tbp_write(connection, "{\"type\":\"play\",\"move\":{\"location\":{\"type\":");
+    tbp_write_piece(connection, move.Piece);
+    tbp_write(connection, ",\"orientation\":\"");
+    tbp_write(connection, s_OrientationNames[move.Orientation & 3]);
+    tbp_write(connection, "\",\"x\":");
+    tbp_write_i32(connection, move.X);
+    tbp_write(connection, ",\"y\":");
+    tbp_write_i32(connection, move.Y);
+    tbp_write(connection, "},\"spin\":\"none\"}}");
+    tbp_flush(connection);
+}
+
+void tbp_send_new_piece(TBPConnection& connection, u32 shapeID) {
+    tbp_write(connection, "{\"type\":\"new_piece\",\"piece\":");
+    tbp_write_piece(connection, tbp_piece_from_shape(shapeID));
+    tbp_write_char(connection, '}');
+    tbp_flush(connection);
+}
+
+void tbp_send_stop(TBPConnection& connection) {
+    tbp_write(connection, "{\"type\":\"stop\"}");
+    tbp_flush(connection);
+}
+
+void tbp_send_quit(TBPConnection& connection) {
+    tbp_write(connection, "{\"type\":\"quit\"}");
+    tbp_flush(connection);
+}
+
+/*
+    Translating a TBP location into one of our placements. Our shapes rotate inside a 4x4 box
+    rather than about an SRS centre, so rather than convert coordinates we compare the four
+    cells the bot wants filled with the cells of every placement the player could actually
+    reach. A match therefore always corresponds to a rotate, slide, hard drop sequence.
+*/
+
+static bool tbp_move_cells(const TBPMove& move, i32 cells[4][2]) {
+    for (u32 p = 0; p < 7; p++) {
+        if (s_PieceCells[p].Piece != move.Piece) {
+            continue;
+        }
+        for (u32 k = 0; k < 4; k++) {
+            i32 x = s_PieceCells[p].Offsets[k][0];
+            i32 y = s_PieceCells[p].Offsets[k][1];
+            for (u32 r = 0; r < move.Orientation; r++) {
+                i32 temp = x;
+                x = y;
+                y = -temp;
+            }
+            cells[k][0] = move.X + x;
+            cells[k][1] = move.Y + y;
+        }
+        return true;
+    }
+    return false;
+}
+
+static bool tbp_placement_has_cell(const Shape& shape, const Placement& placement, i32 col, i32 row) {
+    i32 i = col - placement.X;
+    i32 j = 3 - (row - placement.Y);
+    if (i < 0 || i > 3 || j < 0 || j > 3) {
+        return false;
+    }
+    return shape.Data[j * 4 + i] != 0;
+}
+
+bool tbp_move_to_placement(const SimState& state, const TBPMove& move, Placement* placement) {
+    i32 cells[4][2];
+    if (!tbp_move_cells(move, cells)) {
+        return false;
+    }
+
+    Placement placements[SIM_MAX_PLACEMENTS];
+    u32 count = sim_get_placements(state, placements, true);
+    for (u32 p = 0; p < count; p++) {
+        u32 id = placements[p].Swap ? state.NextID : state.CurrentID;
+        if (tbp_piece_from_shape(id) != move.Piece) {
+            continue;
+        }
+
+        const Shape& shape = shape_get_rotated(id, placements[p].Rotation);
+        bool isMatch = true;
+        for (u32 k = 0; k < 4 && isMatch; k++) {
+            isMatch = tbp_placement_has_cell(shape, placements[p], cells[k][0], cells[k][1]);
+        }
+        if (isMatch) {
+            *placement = placements[p];
+            return true;
+        }
+    }
+    return false;
+}
@@ -0,0 +1,60 @@
+#pragma once
+
+#include "core/base.h"
+#include "core/sim.hpp"
+
+/*
+    Frontend side of the community Tetris Bot Protocol (TBP): newline separated JSON messages,
+    with the frontend (us) sending the game state and the bot answering with suggested moves.
+    Messages are read and written through fixed buffers and scanned in place, so the message
+    loop never allocates.
+
+    Only the subset of TBP that our rules can express is used: there is no separate hold slot
+    (our Swap exchanges the current and next pieces instead) and moves must be reachable by a
+    hard drop, which is how gamestate_playing_update places pieces.
+*/
+
+// Large enough for a start message carrying a full 40 row board.
+#define TBP_MAX_MESSAGE 8192
+
+// TBP boards are 40 rows tall, rows above our field are sent as empty.
+#define TBP_BOARD_HEIGHT 40
+
+enum class TBPMessageType {
+    Unknown,
+    Info,
+    Ready,
+    Error,
+    Suggestion
+};
+
+struct TBPMove {
+    char Piece;
+    u8 Orientation;
+    i32 X;
+    i32 Y;
+};
+
+struct TBPConnection {
+    FILE* In;
+    FILE* Out;
+    char ReadBuffer[TBP_MAX_MESSAGE];
+    char WriteBuffer[TBP_MAX_MESSAGE];
+    u32 WriteLength;
+};
+
+void tbp_init(TBPConnection& connection, FILE* in, FILE* out);
+
+TBPMessageType tbp_read_message(TBPConnection& connection);
+u32 tbp_parse_suggestion(const TBPConnection& connection, TBPMove* moves, u32 maxMoves);
+
+void tbp_send_rules(TBPConnection& connection);
+void tbp_send_start(TBPConnection& connection, const SimState& state);
+void tbp_send_suggest(TBPConnection& connection);
+void tbp_send_play(TBPConnection& connection, const TBPMove& move);
+void tbp_send_new_piece(TBPConnection& connection, u32 shapeID);
+void tbp_send_stop(TBPConnection& connection);
+void tbp_send_quit(TBPConnection& connection);
+
+char tbp_piece_from_shape(u32 shapeID);
+bool tbp_move_to_placement(const SimState& state, const TBPMove& move, Placement* placement);
@@ -0,0 +1,351 @@
+#include "bots/tournament.hpp"
+#include "bots/driver.hpp"
+#include "core/utils.hpp"
+
+#include <algorithm>
+#include <cmath>
+#include <vector>
+
+/*
+    Agent specs are "greedy", "greedy:<weights file>" or "network:<network file>", optionally
+    named with "<name>=" in front. Unnamed agents are called by their spec.
+*/
+
+bool tournament_parse_agent(const char* spec, TournamentAgent* agent) {
+    *agent = {};
+
+    const char* equals = strchr(spec, '=');
+    const char* body = equals ? equals + 1 : spec;
+    size_t nameLength = equals ? (size_t)(equals - spec) : strlen(spec);
+    nameLength = nameLength < TOURNAMENT_NAME_LENGTH - 1 ? nameLength : TOURNAMENT_NAME_LENGTH - 1;
+    memcpy(agent->Name, spec, nameLength);
+    agent->Name[nameLength] = '\0';
+
+    const char* colon = strchr(body, ':');
+    size_t kindLength = colon ? (size_t)(colon - body) : strlen(body);
+    const char* path = colon ? colon + 1 : nullptr;
+
+    if (kindLength == 6 && strncmp(body, "greedy", 6) == 0) {
+        agent->Kind = AgentKind::Greedy;
+        agent->Weights = evaluator_default_weights();
+        return !path || evaluator_load_weights(path, &agent->Weights);
+    }
+
+    if (kindLength == 7 && strncmp(body, "network", 7) == 0 && path) {
+        agent->Kind = AgentKind::Network;
+        agent->Net = network_load(path);
+        return agent->Net != nullptr;
+    }
+
+    CX_ERROR("Unknown agent %s, expected greedy[:weights] or network:<file>.", spec);
+    return false;
+}
+
+void tournament_free_agent(TournamentAgent* agent) {
+    if (agent->Net) {
+        network_destroy(agent->Net);
+        agent->Net = nullptr;
+    }
+}
+
+/*
+    One scheduled game. Period is the rating period it counts towards: a full cycle of the round
+    robin, or one Swiss round.
+*/
+
+struct TournamentGame {
+    u32 Players[VERSUS_PLAYER_COUNT];
+    u32 SeedIndex;
+    u32 Period;
+
+    // Filled in when played.
+    f64 Score; // For Players[0].
+    u32 Ticks;
+    bool Unfinished;
+};
+
+struct Tournament {
+    TournamentConfig Config;
+    const TournamentAgent* Agents;
+    u32 AgentCount;
+    JobPool* Jobs;
+
+    TournamentStanding Standings[TOURNAMENT_MAX_AGENTS];
+    std::vector<u8> HasPlayed; // AgentCount x AgentCount, for Swiss pairing.
+    std::vector<u8> HadBye;
+    TournamentStats Stats;
+};
+
+Tournament* tournament_create(const TournamentConfig& config, const TournamentAgent* agents, u32 agentCount, JobPool* jobs) {
+    CX_ASSERT(agentCount >= 2 && agentCount <= TOURNAMENT_MAX_AGENTS, "A tournament needs between 2 and TOURNAMENT_MAX_AGENTS agents!");
+
+    Tournament* tournament = new Tournament();
+    tournament->Config = config;
+    tournament->Agents = agents;
+    tournament->AgentCount = agentCount;
+    tournament->Jobs = jobs;
+    tournament->HasPlayed.assign(agentCount * agentCount, 0);
+    tournament->HadBye.assign(agentCount, 0);
+    tournament->Stats = {};
+
+    for (u32 i = 0; i < agentCount; i++) {
+        TournamentStanding& standing = tournament->Standings[i];
+        standing = {};
+        standing.Agent = i;
+        standing.Elo = RATING_INITIAL;
+        standing.Glicko = GlickoRating();
+    }
+
+    if (tournament->Config.Rounds == 0) {
+        tournament->Config.Rounds = (u32)ceil(log2((f64)agentCount)) + 2;
+    }
+    return tournament;
+}
+
+void tournament_destroy(Tournament* tournament) {
+    delete tournament;
+}
+
+/*
+    Playing games
+*/
+
+static bool tournament_pick(const TournamentAgent& agent, const GameSim& sim, Placement* placement) {
+    SimState state = driver_sim_state(sim);
+    switch (agent.Kind) {
+        case AgentKind::Greedy:
+            return evaluator_pick_placement(state, agent.Weights, sim.CanSwap, placement);
+        case AgentKind::Network:
+            return network_pick_placement(agent.Net, state, sim.CanSwap, placement);
+    }
+    return false;
+}
+
+struct TournamentBatch {
+    const Tournament* Owner;
+    TournamentGame* Games;
+};
+
+static void tournament_play_job(void* userData, u32 index, u32 /* threadIndex */) {
+    TournamentBatch* batch = (TournamentBatch*)userData;
+    const Tournament* tournament = batch->Owner;
+    TournamentGame& game = batch->Games[index];
+    const TournamentConfig& config = tournament->Config;
+
+    VersusMatch match;
+    versus_reset(match, Utils::HashPCG(config.Seed + 2 * game.SeedIndex), Utils::HashPCG(config.Seed + 2 * game.SeedIndex + 1));
+
+    InputDriver drivers[VERSUS_PLAYER_COUNT] = {};
+    while (match.Outcome == VersusOutcome::Playing && match.Tick < config.MaxTicks) {
+        GameInput inputs[VERSUS_PLAYER_COUNT];
+        for (u32 p = 0; p < VERSUS_PLAYER_COUNT; p++) {
+            const GameSim& sim = match.Players[p].Sim;
+            Placement placement;
+            if (!drivers[p].Active && tournament_pick(tournament->Agents[game.Players[p]], sim, &placement)) {
+                driver_start(drivers[p], placement);
+            }
+            inputs[p] = driver_next_input(drivers[p], sim);
+        }
+        versus_step(match, inputs);
+    }
+
+    game.Ticks = match.Tick;
+    game.Unfinished = match.Outcome == VersusOutcome::Playing;
+    if (match.Outcome == VersusOutcome::Won) {
+        game.Score = match.Winner == 0 ? 1.0 : 0.0;
+    } else if (game.Unfinished && match.Players[0].LinesSent != match.Players[1].LinesSent) {
+        game.Score = match.Players[0].LinesSent > match.Players[1].LinesSent ? 1.0 : 0.0;
+    } else {
+        game.Score = 0.5;
+    }
+}
+
+static void tournament_play(Tournament* tournament, std::vector<TournamentGame>& games) {
+    TournamentBatch batch = { tournament, games.data() };
+    Utils::Clock timer;
+    jobs_parallel_for(tournament->Jobs, (u32)games.size(), tournament_play_job, &batch);
+    tournament->Stats.Seconds += timer.Tick();
+
+    for (const TournamentGame& game : games) {
+        tournament->Stats.Games++;
+        tournament->Stats.Unfinished += game.Unfinished;
+        tournament->Stats.Ticks += game.Ticks;
+    }
+}
+
+/*
+    Results and ratings are applied in schedule order once a batch is done, never in the order
+    threads finished, so a tournament comes out the same on any number of cores.
+*/
+
+static void tournament_record(Tournament* tournament, const TournamentGame& game) {
+    f64 scores[VERSUS_PLAYER_COUNT] = { game.Score, 1.0 - game.Score };
+    for (u32 p = 0; p < VERSUS_PLAYER_COUNT; p++) {
+        TournamentStanding& standing = tournament->Standings[game.Players[p]];
+        standing.Games++;
+        standing.Points += scores[p];
+        standing.Wins += scores[p] == 1.0;
+        standing.Draws += scores[p] == 0.5;
+        standing.Losses += scores[p] == 0.0;
+    }
+
+    rating_elo_update(
+        tournament->Standings[game.Players[0]].Elo,
+        tournament->Standings[game.Players[1]].Elo,
+        game.Score
+    );
+}
+
+static void tournament_rate_period(Tournament* tournament, const std::vector<TournamentGame>& games, u32 period) {
+    std::vector<GlickoGame> results[TOURNAMENT_MAX_AGENTS];
+    for (const TournamentGame& game : games) {
+        if (game.Period != period) {
+            continue;
+        }
+        tournament_record(tournament, game);
+
+        f64 scores[VERSUS_PLAYER_COUNT] = { game.Score, 1.0 - game.Score };
+        for (u32 p = 0; p < VERSUS_PLAYER_COUNT; p++) {
+            const GlickoRating& opponent = tournament->Standings[game.Players[1 - p]].Glicko;
+            results[game.Players[p]].push_back({ opponent.Rating, opponent.Deviation, scores[p] });
+        }
+    }
+
+    // Everyone is rated against the opponents' ratings from before the period.
+    for (u32 i = 0; i < tournament->AgentCount; i++) {
+        GlickoRating& rating = tournament->Standings[i].Glicko;
+        rating = rating_glicko_update(rating, results[i].data(), (u32)results[i].size());
+    }
+}
+
+static void tournament_schedule_pairing(const Tournament* tournament, u32 a, u32 b, u32 period, std::vector<TournamentGame>& games) {
+    for (u32 g = 0; g < tournament->Config.GamesPerPairing; g++) {
+        TournamentGame game = {};
+        game.Players[0] = a;
+        game.Players[1] = b;
+        game.SeedIndex = period * tournament->Config.GamesPerPairing + g;
+        game.Period = period;
+        games.push_back(game);
+    }
+}
+
+/*
+    Round robin: every pair meets GamesPerPairing times, each game of a pair on its own seed.
+    Game g of every pairing is one rating period, a full cycle through the field.
+*/
+
+static void tournament_run_round_robin(Tournament* tournament) {
+    std::vector<TournamentGame> games;
+    for (u32 g = 0; g < tournament->Config.GamesPerPairing; g++) {
+        for (u32 a = 0; a < tournament->AgentCount; a++) {
+            for (u32 b = a + 1; b < tournament->AgentCount; b++) {
+                TournamentGame game = {};
+                game.Players[0] = a;
+                game.Players[1] = b;
+                game.SeedIndex = g;
+                game.Period = g;
+                games.push_back(game);
+            }
+        }
+    }
+
+    tournament_play(tournament, games);
+    for (u32 g = 0; g < tournament->Config.GamesPerPairing; g++) {
+        tournament_rate_period(tournament, games, g);
+    }
+}
+
+/*
+    Swiss: each round pairs agents on equal points where possible, leaders first, without
+    repeating a pairing unless nothing else is left. With an odd field the lowest agent that
+    has not had one gets a bye, worth a win per game and no rating change. Bye wins count in the
+    agent's games and wins so the standings add up to its points, but not in Stats.Games.
+*/
+
+static void tournament_run_swiss(Tournament* tournament) {
+    u32 count = tournament->AgentCount;
+    for (u32 round = 0; round < tournament->Config.Rounds; round++) {
+        std::vector<u32> order(count);
+        for (u32 i = 0; i < count; i++) {
+            order[i] = i;
+        }
+        std::stable_sort(order.begin(), order.end(), [&](u32 a, u32 b) {
+            const TournamentStanding& sa = tournament->Standings[a];
+            const TournamentStanding& sb = tournament->Standings[b];
+            return sa.Points != sb.Points ? sa.Points > sb.Points : sa.Elo > sb.Elo;
+        });
+
+        std::vector<u8> paired(count, 0);
+        if (count % 2) {
+            for (u32 i = count; i-- > 0;) {
+                if (!tournament->HadBye[order[i]] || i == 0) {
+                    u32 bye = order[i];
+                    paired[bye] = 1;
+                    tournament->HadBye[bye] = 1;
+                    TournamentStanding& standing = tournament->Standings[bye];
+                    standing.Games += tournament->Config.GamesPerPairing;
+                    standing.Wins += tournament->Config.GamesPerPairing;
+                    standing.Points += tournament->Config.GamesPerPairing;
+                    break;
+                }
+            }
+        }
+
+        std::vector<TournamentGame> games;
+        for (u32 i = 0; i < count; i++) {
+            u32 a = order[i];
+            if (paired[a]) {
+                continue;
+            }
+
+            u32 opponent = UINT32_MAX;
+            for (u32 j = i + 1; j < count; j++) {
+                u32 b = order[j];
+                if (paired[b]) {
+                    continue;
+                }
+                if (opponent == UINT32_MAX) {
+                    opponent = b; // Rematch as a last resort.
+                }
+                if (!tournament->HasPlayed[a * count + b]) {
+                    opponent = b;
+                    break;
+                }
+            }
+
+            paired[a] = paired[opponent] = 1;
+            tournament->HasPlayed[a * count + opponent] = tournament->HasPlayed[opponent * count + a] = 1;
+            tournament_schedule_pairing(tournament, a, opponent, round, games);
+        }
+
+        tournament_play(tournament, games);
+        tournament_rate_period(tournament, games, round);
+    }
+}
+
+void tournament_run(Tournament* tournament) {
+    switch (tournament->Config.Format) {
+        case TournamentFormat::RoundRobin:
+            tournament_run_round_robin(tournament);
+            break;
+        case TournamentFormat::Swiss:
+            tournament_run_swiss(tournament);
+            break;
+    }
+}
+
+/*
+    Writes one standing per agent, best Glicko rating first, and returns how many.
+*/
+
+u32 tournament_get_standings(const Tournament* tournament, TournamentStanding* standings) {
+    memcpy(standings, tournament->Standings, sizeof(TournamentStanding) * tournament->AgentCount);
+    std::stable_sort(standings, standings + tournament->AgentCount, [](const TournamentStanding& a, const TournamentStanding& b) {
+        return a.Glicko.Rating > b.Glicko.Rating;
+    });
+    return tournament->AgentCount;
+}
+
+TournamentStats tournament_get_stats(const Tournament* tournament) {
+    return tournament->Stats;
+}
@@ -0,0 +1,73 @@
+#pragma once
+
+#include "core/base.h"
+#include "core/jobs.hpp"
+#include "core/versus.hpp"
+#include "bots/evaluator.hpp"
+#include "bots/network.hpp"
+#include "bots/rating.hpp"
+
+/*
+    Bot against bot versus tournaments. Every game of a pairing is played from a seed shared by
+    all pairings (game g always has the same pieces and garbage), so results compare agents
+    rather than luck. All the games that can run at once are handed to the job pool together:
+    the whole schedule for a round robin, one round at a time for Swiss.
+*/
+
+#define TOURNAMENT_MAX_AGENTS 256
+#define TOURNAMENT_NAME_LENGTH 64
+
+enum class AgentKind {
+    Greedy,  // evaluator_pick_placement, with default or loaded weights.
+    Network, // network_pick_placement.
+};
+
+struct TournamentAgent {
+    char Name[TOURNAMENT_NAME_LENGTH];
+    AgentKind Kind;
+    EvalWeights Weights;
+    Network* Net;
+};
+
+bool tournament_parse_agent(const char* spec, TournamentAgent* agent);
+void tournament_free_agent(TournamentAgent* agent);
+
+enum class TournamentFormat {
+    RoundRobin,
+    Swiss,
+};
+
+struct TournamentConfig {
+    TournamentFormat Format = TournamentFormat::RoundRobin;
+    u32 GamesPerPairing = 4;
+    u32 Rounds = 0;                         // Swiss only, 0 picks log2(agents) + 2.
+    u32 MaxTicks = 5 * 60 * VERSUS_TICK_RATE; // Unfinished games go to whoever sent more garbage.
+    u32 Seed = 1;
+};
+
+struct TournamentStanding {
+    u32 Agent;
+    u32 Games;
+    u32 Wins;
+    u32 Draws;
+    u32 Losses;
+    f64 Points;
+    f64 Elo;
+    GlickoRating Glicko;
+};
+
+struct TournamentStats {
+    u64 Games;
+    u64 Unfinished;
+    u64 Ticks;
+    f64 Seconds;
+};
+
+struct Tournament;
+
+Tournament* tournament_create(const TournamentConfig& config, const TournamentAgent* agents, u32 agentCount, JobPool* jobs);
+void tournament_destroy(Tournament* tournament);
+void tournament_run(Tournament* tournament);
+
+u32 tournament_get_standings(const Tournament* tournament, TournamentStanding* standings);
+TournamentStats tournament_get_stats(const Tournament* tournament);
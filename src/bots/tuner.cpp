@@ -0,0 +1,251 @@
+#include "bots/tuner.hpp"
+
+#include "core/sim.hpp"
+#include "maths/random.hpp"
+
+#include <algorithm>
+#include <cmath>
+#include <vector>
+
+#define TUNER_DIMENSIONS EVAL_FEATURE_COUNT
+
+struct TunerCandidate {
+    f32 Z[TUNER_DIMENSIONS]; // Sample in isotropic space.
+    f32 Y[TUNER_DIMENSIONS]; // Sample scaled by the diagonal covariance.
+    EvalWeights Weights;
+    f32 Fitness;
+};
+
+struct Tuner {
+    TunerConfig Config;
+    JobPool* Jobs;
+    u32 Seed;
+
+    // Strategy parameters, see Hansen's "The CMA Evolution Strategy: A Tutorial".
+    u32 Lambda;
+    u32 Mu;
+    std::vector<f32> RecombinationWeights;
+    f32 MuEff;
+    f32 CSigma;
+    f32 DSigma;
+    f32 CC;
+    f32 C1;
+    f32 CMu;
+    f32 ExpectedNorm;
+
+    // Strategy state.
+    f32 Mean[TUNER_DIMENSIONS];
+    f32 Variance[TUNER_DIMENSIONS];
+    f32 PathSigma[TUNER_DIMENSIONS];
+    f32 PathC[TUNER_DIMENSIONS];
+    f32 Sigma;
+
+    std::vector<TunerCandidate> Candidates;
+    std::vector<u32> GameSeeds;
+    std::vector<u32> GameLines;  // Per (candidate, game) job, so workers never share a counter.
+    std::vector<u32> GamePieces;
+    TunerStats Stats;
+};
+
+/*
+    The greedy search is scale invariant, only the direction of the weight vector matters, so
+    candidates are normalised before they are played.
+*/
+
+static EvalWeights tuner_normalised(const f32* values) {
+    f32 lengthSqr = 0.0f;
+    for (u32 i = 0; i < TUNER_DIMENSIONS; i++) {
+        lengthSqr += values[i] * values[i];
+    }
+    f32 inv = lengthSqr > 0.0f ? 1.0f / sqrtf(lengthSqr) : 1.0f;
+
+    EvalWeights weights;
+    for (u32 i = 0; i < TUNER_DIMENSIONS; i++) {
+        weights.Values[i] = values[i] * inv;
+    }
+    return weights;
+}
+
+Tuner* tuner_create(const TunerConfig& config, const EvalWeights& initial, JobPool* jobs) {
+    CX_ASSERT(config.GamesPerCandidate > 0, "Tuner needs at least one game per candidate!");
+
+    Tuner* tuner = new Tuner();
+    tuner->Config = config;
+    tuner->Jobs = jobs;
+    tuner->Seed = Utils::HashPCG(config.Seed);
+
+    const f32 n = (f32)TUNER_DIMENSIONS;
+    tuner->Lambda = config.Population ? config.Population : 4 + (u32)(3.0f * logf(n));
+    tuner->Lambda = tuner->Lambda < 4 ? 4 : tuner->Lambda;
+    tuner->Mu = tuner->Lambda / 2;
+
+    f32 weightSum = 0.0f;
+    f32 weightSqrSum = 0.0f;
+    for (u32 i = 0; i < tuner->Mu; i++) {
+        f32 w = logf((f32)tuner->Mu + 0.5f) - logf((f32)i + 1.0f);
+        tuner->RecombinationWeights.push_back(w);
+        weightSum += w;
+    }
+    for (f32& w : tuner->RecombinationWeights) {
+        w /= weightSum;
+        weightSqrSum += w * w;
+    }
+    tuner->MuEff = 1.0f / weightSqrSum;
+
+    f32 muEff = tuner->MuEff;
+    tuner->CSigma = (muEff + 2.0f) / (n + muEff + 5.0f);
+    tuner->DSigma = 1.0f + 2.0f * std::max(0.0f, sqrtf((muEff - 1.0f) / (n + 1.0f)) - 1.0f) + tuner->CSigma;
+    tuner->CC = (4.0f + muEff / n) / (n + 4.0f + 2.0f * muEff / n);
+
+    // Separable CMA-ES can afford faster covariance learning rates, by a factor of (n + 2) / 3.
+    f32 separableBoost = (n + 2.0f) / 3.0f;
+    tuner->C1 = std::min(1.0f, separableBoost * 2.0f / ((n + 1.3f) * (n + 1.3f) + muEff));
+    tuner->CMu = std::min(1.0f - tuner->C1, separableBoost * 2.0f * (muEff - 2.0f + 1.0f / muEff) / ((n + 2.0f) * (n + 2.0f) + muEff));
+    tuner->ExpectedNorm = sqrtf(n) * (1.0f - 1.0f / (4.0f * n) + 1.0f / (21.0f * n * n));
+
+    EvalWeights start = tuner_normalised(initial.Values);
+    for (u32 i = 0; i < TUNER_DIMENSIONS; i++) {
+        tuner->Mean[i] = start.Values[i];
+        tuner->Variance[i] = 1.0f;
+        tuner->PathSigma[i] = 0.0f;
+        tuner->PathC[i] = 0.0f;
+    }
+    tuner->Sigma = config.InitialSigma;
+
+    tuner->Candidates.resize(tuner->Lambda);
+    tuner->GameSeeds.resize(config.GamesPerCandidate);
+    tuner->GameLines.resize(tuner->Lambda * config.GamesPerCandidate);
+    tuner->GamePieces.resize(tuner->Lambda * config.GamesPerCandidate);
+    tuner->Stats = {};
+    tuner->Stats.Sigma = tuner->Sigma;
+    return tuner;
+}
+
+void tuner_destroy(Tuner* tuner) {
+    delete tuner;
+}
+
+/*
+    One job per (candidate, game) pair, so a generation spreads evenly over every core. Games
+    are capped at MaxPieces because a decent set of weights can otherwise play indefinitely.
+*/
+
+static void tuner_play_job(void* userData, u32 index, u32 /* threadIndex */) {
+    Tuner* tuner = (Tuner*)userData;
+    u32 games = tuner->Config.GamesPerCandidate;
+    const TunerCandidate& candidate = tuner->Candidates[index / games];
+
+    SimState state;
+    sim_reset(state, tuner->GameSeeds[index % games]);
+    while (!state.IsOver && state.Pieces < tuner->Config.MaxPieces) {
+        Placement placement;
+        if (!evaluator_pick_placement(state, candidate.Weights, true, &placement)) {
+            break;
+        }
+        sim_apply_placement(state, placement);
+    }
+
+    tuner->GameLines[index] = state.Lines;
+    tuner->GamePieces[index] = state.Pieces;
+}
+
+void tuner_step(Tuner* tuner) {
+    Utils::Clock clock;
+    const u32 n = TUNER_DIMENSIONS;
+
+    // Sample the population.
+    for (TunerCandidate& candidate : tuner->Candidates) {
+        f32 x[TUNER_DIMENSIONS];
+        for (u32 i = 0; i < n; i++) {
+            candidate.Z[i] = RandNormal(tuner->Seed);
+            candidate.Y[i] = sqrtf(tuner->Variance[i]) * candidate.Z[i];
+            x[i] = tuner->Mean[i] + tuner->Sigma * candidate.Y[i];
+        }
+        candidate.Weights = tuner_normalised(x);
+    }
+
+    for (u32& seed : tuner->GameSeeds) {
+        seed = RandU32(tuner->Seed);
+    }
+
+    u32 jobCount = (u32)tuner->Candidates.size() * tuner->Config.GamesPerCandidate;
+    jobs_parallel_for(tuner->Jobs, jobCount, tuner_play_job, tuner);
+
+    // Fitness is lines cleared per game, higher is better.
+    u32 games = tuner->Config.GamesPerCandidate;
+    f32 fitnessSum = 0.0f;
+    for (u32 c = 0; c < tuner->Candidates.size(); c++) {
+        u64 lines = 0;
+        for (u32 g = 0; g < games; g++) {
+            lines += tuner->GameLines[c * games + g];
+            tuner->Stats.PiecesPlayed += tuner->GamePieces[c * games + g];
+        }
+        tuner->Candidates[c].Fitness = (f32)lines / (f32)games;
+        fitnessSum += tuner->Candidates[c].Fitness;
+    }
+    tuner->Stats.GamesPlayed += jobCount;
+
+    std::sort(tuner->Candidates.begin(), tuner->Candidates.end(), [](const TunerCandidate& a, const TunerCandidate& b) {
+        return a.Fitness > b.Fitness;
+    });
+
+    // Recombine the best Mu candidates into the new mean.
+    f32 yw[TUNER_DIMENSIONS] = {};
+    f32 zw[TUNER_DIMENSIONS] = {};
+    for (u32 k = 0; k < tuner->Mu; k++) {
+        f32 w = tuner->RecombinationWeights[k];
+        for (u32 i = 0; i < n; i++) {
+            yw[i] += w * tuner->Candidates[k].Y[i];
+            zw[i] += w * tuner->Candidates[k].Z[i];
+        }
+    }
+    for (u32 i = 0; i < n; i++) {
+        tuner->Mean[i] += tuner->Sigma * yw[i];
+    }
+
+    // Evolution paths. With a diagonal covariance C^(-1/2) y is just z.
+    f32 sigmaScale = sqrtf(tuner->CSigma * (2.0f - tuner->CSigma) * tuner->MuEff);
+    f32 pathSigmaNormSqr = 0.0f;
+    for (u32 i = 0; i < n; i++) {
+        tuner->PathSigma[i] = (1.0f - tuner->CSigma) * tuner->PathSigma[i] + sigmaScale * zw[i];
+        pathSigmaNormSqr += tuner->PathSigma[i] * tuner->PathSigma[i];
+    }
+    f32 pathSigmaNorm = sqrtf(pathSigmaNormSqr);
+
+    u32 generation = tuner->Stats.Generation + 1;
+    f32 decay = 1.0f - powf(1.0f - tuner->CSigma, 2.0f * (f32)generation);
+    bool hSigma = pathSigmaNorm / sqrtf(decay) < (1.4f + 2.0f / ((f32)n + 1.0f)) * tuner->ExpectedNorm;
+
+    f32 cScale = sqrtf(tuner->CC * (2.0f - tuner->CC) * tuner->MuEff);
+    for (u32 i = 0; i < n; i++) {
+        tuner->PathC[i] = (1.0f - tuner->CC) * tuner->PathC[i] + (hSigma ? cScale * yw[i] : 0.0f);
+    }
+
+    // Diagonal covariance update: rank-one from the path, rank-mu from the selected steps.
+    f32 hCorrection = hSigma ? 0.0f : tuner->CC * (2.0f - tuner->CC);
+    for (u32 i = 0; i < n; i++) {
+        f32 rankMu = 0.0f;
+        for (u32 k = 0; k < tuner->Mu; k++) {
+            f32 y = tuner->Candidates[k].Y[i];
+            rankMu += tuner->RecombinationWeights[k] * y * y;
+        }
+        f32 rankOne = tuner->PathC[i] * tuner->PathC[i] + hCorrection * tuner->Variance[i];
+        tuner->Variance[i] = (1.0f - tuner->C1 - tuner->CMu) * tuner->Variance[i] + tuner->C1 * rankOne + tuner->CMu * rankMu;
+    }
+
+    tuner->Sigma *= expf((tuner->CSigma / tuner->DSigma) * (pathSigmaNorm / tuner->ExpectedNorm - 1.0f));
+
+    tuner->Stats.Generation = generation;
+    tuner->Stats.Sigma = tuner->Sigma;
+    tuner->Stats.BestFitness = tuner->Candidates[0].Fitness;
+    tuner->Stats.MeanFitness = fitnessSum / (f32)tuner->Candidates.size();
+    tuner->Stats.Seconds += clock.Tick();
+}
+
+EvalWeights tuner_get_mean(Tuner* tuner) {
+    return tuner_normalised(tuner->Mean);
+}
+
+TunerStats tuner_get_stats(Tuner* tuner) {
+    return tuner->Stats;
+}
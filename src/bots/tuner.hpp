@@ -0,0 +1,39 @@
+#pragma once
+
+#include "core/base.h"
+#include "core/jobs.hpp"
+#include "bots/evaluator.hpp"
+
+/*
+    Evaluator weight tuner using separable CMA-ES (a diagonal covariance, which is plenty for a
+    handful of weights). Each candidate is scored by playing seeded games with the greedy
+    placement search. All candidates in a generation play the same piece sequences (common
+    random numbers), so fitness differences come from the weights and not from lucky seeds.
+*/
+
+struct TunerConfig {
+    u32 Population = 0; // Zero picks the usual 4 + 3 ln(n).
+    u32 GamesPerCandidate = 100;
+    u32 MaxPieces = 500;
+    f32 InitialSigma = 0.3f;
+    u32 Seed = 1;
+};
+
+struct TunerStats {
+    u32 Generation;
+    f32 Sigma;
+    f32 BestFitness;
+    f32 MeanFitness;
+    u64 GamesPlayed;
+    u64 PiecesPlayed;
+    f64 Seconds;
+};
+
+struct Tuner;
+
+Tuner* tuner_create(const TunerConfig& config, const EvalWeights& initial, JobPool* jobs);
+void tuner_destroy(Tuner* tuner);
+
+void tuner_step(Tuner* tuner);
+EvalWeights tuner_get_mean(Tuner* tuner);
+TunerStats tuner_get_stats(Tuner* tuner);
@@ -0,0 +1,167 @@
+#include "core/archive.hpp"
+
+#if !CORTEX_PLATFORM_WEB
+    #include <fcntl.h>
+    #include <sys/mman.h>
+    #include <sys/stat.h>
+    #include <unistd.h>
+#endif
+
+/*
+    Maps the file on desktop. The web build fetches the archive itself, so this is only there
+    for completeness and reads the file whole.
+*/
+
+static const u8* archive_map(const char* path, u64* size) {
+#if CORTEX_PLATFORM_WEB
+    FILE* file = fopen(path, "rb");
+    if (!file) {
+        return nullptr;
+    }
+
+    fseek(file, 0, SEEK_END);
+    i64 length = ftell(file);
+    fseek(file, 0, SEEK_SET);
+
+    u8* data = length > 0 ? new u8[length] : nullptr;
+    if (data && fread(data, 1, (size_t)length, file) != (size_t)length) {
+        delete[] data;
+        data = nullptr;
+    }
+    fclose(file);
+
+    *size = (u64)length;
+    return data;
+#else
+    i32 fd = open(path, O_RDONLY);
+    if (fd < 0) {
+        return nullptr;
+    }
+
+    struct stat info;
+    void* mapping = MAP_FAILED;
+    if (fstat(fd, &info) == 0 && info.st_size > 0) {
+        mapping = mmap(nullptr, (size_t)info.st_size, PROT_READ, MAP_PRIVATE, fd, 0);
+    }
+    close(fd);
+
+    if (mapping == MAP_FAILED) {
+        return nullptr;
+    }
+    *size = (u64)info.st_size;
+    return (const u8*)mapping;
+#endif
+}
+
+static void archive_release(const u8* data, u64 size, bool isMapped) {
+#if !CORTEX_PLATFORM_WEB
+    if (isMapped) {
+        munmap((void*)data, (size_t)size);
+        return;
+    }
+#endif
+    delete[] data;
+}
+
+/*
+    Checks the header and index, taking over `data` if they are good. Every entry has to lie
+    inside the archive, so lookups never need to check again.
+*/
+
+static bool archive_adopt(AssetArchive* archive, const u8* data, u64 size, bool isMapped) {
+    memset(archive, 0, sizeof(*archive));
+
+    const ArchiveHeader* header = (const ArchiveHeader*)data;
+    bool isValid = size >= sizeof(ArchiveHeader)
+        && memcmp(header->Magic, ARCHIVE_MAGIC, sizeof(header->Magic)) == 0
+        && header->Version == ARCHIVE_VERSION
+        && header->EntryCount <= (size - sizeof(ArchiveHeader)) / sizeof(ArchiveEntry);
+
+    const ArchiveEntry* entries = (const ArchiveEntry*)(data + sizeof(ArchiveHeader));
+    for (u32 i = 0; isValid && i < header->EntryCount; i++) {
+        isValid = (u64)entries[i].Offset + entries[i].Size <= size
+            && entries[i].Name[ARCHIVE_NAME_LENGTH - 1] == '\0';
+    }
+
+    if (!isValid) {
+        archive_release(data, size, isMapped);
+        return false;
+    }
+
+    archive->Header = header;
+    archive->Entries = entries;
+    archive->Data = data;
+    archive->Size = size;
+    archive->IsMapped = isMapped;
+    return true;
+}
+
+bool archive_open(AssetArchive* archive, const char* path) {
+    memset(archive, 0, sizeof(*archive));
+
+    u64 size = 0;
+    const u8* data = archive_map(path, &size);
+    if (!data) {
+        CX_ERROR("Failed to open %s.", path);
+        return false;
+    }
+
+    if (!archive_adopt(archive, data, size, !CORTEX_PLATFORM_WEB)) {
+        CX_ERROR("%s is not a compatible asset archive.", path);
+        return false;
+    }
+    return true;
+}
+
+/*
+    Opens an archive that is already in memory, allocated with new[]. The archive owns it from
+    here on, whether or not it turns out to be valid.
+*/
+
+bool archive_open_memory(AssetArchive* archive, const u8* data, u64 size) {
+    if (!archive_adopt(archive, data, size, false)) {
+        CX_ERROR("Not a compatible asset archive.");
+        return false;
+    }
+    return true;
+}
+
+void archive_close(AssetArchive* archive) {
+    if (archive->Data) {
+        archive_release(archive->Data, archive->Size, archive->IsMapped);
+    }
+    memset(archive, 0, sizeof(*archive));
+}
+
+/*
+    Binary search of the sorted index. The data stays valid until the archive is closed.
+*/
+
+bool archive_find(const AssetArchive* archive, const char* name, const u8** data, u32* size) {
+    i32 low = 0;
+    i32 high = archive->Data ? (i32)archive->Header->EntryCount - 1 : -1;
+    while (low <= high) {
+        i32 mid = (low + high) / 2;
+        const ArchiveEntry& entry = archive->Entries[mid];
+        i32 order = strcmp(name, entry.Name);
+        if (order == 0) {
+            *data = archive->Data + entry.Offset;
+            *size = entry.Size;
+            return true;
+        }
+        if (order < 0) {
+            high = mid - 1;
+        } else {
+            low = mid + 1;
+        }
+    }
+    return false;
+}
+
+u64 archive_hash(u64 hash, const void* data, u64 size) {
+    const u8* bytes = (const u8*)data;
+    for (u64 i = 0; i < size; i++) {
+        hash = (hash ^ bytes[i]) * 0x100000001b3ull;
+    }
+    return hash;
+}
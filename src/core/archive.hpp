@@ -0,0 +1,51 @@
+#pragma once
+
+#include "core/base.h"
+
+/*
+    Packed asset archive, built from assets/ by the pack-assets tool as part of the build. A
+    64 byte header is followed by an index of fixed-width entries sorted by name, then the
+    file contents, each aligned to ARCHIVE_ALIGNMENT. The whole archive is mapped (fetched in
+    one go on the web, see archive_open_memory), so an asset is a pointer and size into it that
+    fonts and audio decode from directly.
+*/
+
+#define ARCHIVE_MAGIC "TTRSPAK"
+#define ARCHIVE_VERSION 1
+#define ARCHIVE_NAME_LENGTH 56
+#define ARCHIVE_ALIGNMENT 16
+#define ARCHIVE_PATH "assets.pak"
+#define ARCHIVE_HASH_SEED 0xcbf29ce484222325ull
+
+struct ArchiveHeader {
+    char Magic[8];
+    u32 Version;
+    u32 EntryCount;
+    u64 ContentHash;  // FNV-1a over every file's name and bytes, identifies a content build.
+    u8 Reserved[40];
+};
+
+STATIC_ASSERT(sizeof(ArchiveHeader) == 64, "Archive header layout must not change.");
+
+struct ArchiveEntry {
+    char Name[ARCHIVE_NAME_LENGTH]; // Path relative to assets/, nul terminated.
+    u32 Offset;                     // From the start of the archive.
+    u32 Size;
+};
+
+STATIC_ASSERT(sizeof(ArchiveEntry) == 64, "Archive entry layout must not change.");
+
+struct AssetArchive {
+    const ArchiveHeader* Header;
+    const ArchiveEntry* Entries;
+    const u8* Data;
+    u64 Size;
+    bool IsMapped; // Otherwise Data was allocated with new[] and is freed on close.
+};
+
+bool archive_open(AssetArchive* archive, const char* path);
+bool archive_open_memory(AssetArchive* archive, const u8* data, u64 size);
+void archive_close(AssetArchive* archive);
+bool archive_find(const AssetArchive* archive, const char* name, const u8** data, u32* size);
+
+u64 archive_hash(u64 hash, const void* data, u64 size);
@@ -0,0 +1,512 @@
+#include "core/audio.hpp"
+#include "core/platform.hpp"
+#include "maths/numerics.hpp"
+
+#include "soloud.h"
+#include "soloud_wav.h"
+#include "soloud_wavstream.h"
+#include "soloud_sfxr.h"
+
+#include <atomic>
+#include <new>
+
+#if !CORTEX_PLATFORM_WEB
+    #include <fcntl.h>
+    #include <sys/mman.h>
+    #include <sys/stat.h>
+    #include <unistd.h>
+#endif
+
+/*
+    Sound effects decode to float PCM once, held by the Wav, and every voice playing one reads
+    that same buffer. SoLoud news an instance for each play and deletes it when the voice ends
+    (on whichever thread that happens), so the instances come from a fixed block instead of the
+    heap. Slots are claimed with a compare-exchange, which is all the locking two threads need.
+*/
+
+class PooledWavInstance : public SoLoud::WavInstance {
+public:
+    PooledWavInstance(SoLoud::Wav* parent) : SoLoud::WavInstance(parent) {}
+
+    static void* operator new(size_t size);
+    static void operator delete(void* memory);
+};
+
+// Stealing stops a voice before the next one starts, so this many instances are never all in use.
+#define AUDIO_INSTANCE_POOL_SIZE (AUDIO_MAX_VOICES + 4)
+
+struct alignas(16) InstanceStorage {
+    u8 Bytes[sizeof(PooledWavInstance)];
+};
+
+static InstanceStorage s_InstanceStorage[AUDIO_INSTANCE_POOL_SIZE];
+static std::atomic<bool> s_InstanceInUse[AUDIO_INSTANCE_POOL_SIZE];
+
+void* PooledWavInstance::operator new(size_t size) {
+    for (u32 i = 0; i < AUDIO_INSTANCE_POOL_SIZE; i++) {
+        bool expected = false;
+        if (s_InstanceInUse[i].compare_exchange_strong(expected, true, std::memory_order_acquire)) {
+            return &s_InstanceStorage[i];
+        }
+    }
+    return ::operator new(size);
+}
+
+void PooledWavInstance::operator delete(void* memory) {
+    InstanceStorage* storage = (InstanceStorage*)memory;
+    if (storage >= s_InstanceStorage && storage < s_InstanceStorage + AUDIO_INSTANCE_POOL_SIZE) {
+        s_InstanceInUse[storage - s_InstanceStorage].store(false, std::memory_order_release);
+    } else {
+        ::operator delete(memory);
+    }
+}
+
+class AudioSample : public SoLoud::Wav {
+public:
+    virtual SoLoud::AudioSourceInstance* createInstance() {
+        return new PooledWavInstance(this);
+    }
+};
+
+/*
+    Files are mapped rather than read where the platform allows: a stream then decodes straight
+    out of the page cache as it plays. The web has no mapping, so there the whole file is read.
+*/
+
+static const u8* audio_map_file(const char* path, size_t* size) {
+#if CORTEX_PLATFORM_WEB
+    return (const u8*)SDL_LoadFile(path, size);
+#else
+    i32 file = open(path, O_RDONLY);
+    if (file < 0) {
+        return nullptr;
+    }
+
+    struct stat info;
+    void* mapping = MAP_FAILED;
+    if (fstat(file, &info) == 0 && info.st_size > 0) {
+        mapping = mmap(nullptr, (size_t)info.st_size, PROT_READ, MAP_PRIVATE, file, 0);
+    }
+    close(file);
+
+    if (mapping == MAP_FAILED) {
+        return nullptr;
+    }
+    *size = (size_t)info.st_size;
+    return (const u8*)mapping;
+#endif
+}
+
+static void audio_unmap_file(const u8* data, size_t size) {
+#if CORTEX_PLATFORM_WEB
+    SDL_free((void*)data);
+#else
+    munmap((void*)data, size);
+#endif
+}
+
+struct AudioSoundSlot {
+    char Path[AUDIO_PATH_LENGTH];
+    bool IsStream;
+    bool IsLooping;
+
+    bool IsSynth;
+    AudioSynth Synth;
+
+    // Set by the audio thread once the sound has loaded, null if it failed.
+    SoLoud::AudioSource* Source;
+
+    // Streams keep their file mapped for as long as they exist.
+    const u8* Mapping;
+    size_t MappingSize;
+
+    // Set instead of loading from Path when the file is already in memory (the asset archive),
+    // which the audio layer only ever reads.
+    const u8* Memory;
+    size_t MemorySize;
+};
+
+enum class AudioCommandType : u8 {
+    Load,
+    Play,
+    SetVolume,
+    Stop,
+};
+
+struct AudioCommand {
+    AudioCommandType Type;
+    u8 Channel;
+    AudioSound Sound;
+    f32 Volume;
+};
+
+struct PlatformAudio {
+    SoLoud::Soloud Engine;
+
+    // The game thread fills in a slot's path before queueing its load, the audio thread does
+    // the rest.
+    AudioSoundSlot Sounds[AUDIO_MAX_SOUNDS];
+    u32 SoundCount;
+
+    // Audio thread only.
+    SoLoud::handle Channels[AUDIO_MAX_CHANNELS];
+    SoLoud::handle Voices[AUDIO_MAX_VOICES];
+    u32 VoiceStarted[AUDIO_MAX_VOICES];
+    u32 PlayCount;
+
+    // Game thread only. Volume changes are held until audio_flush and only sent if they differ
+    // from what the channel already has, so setting one every frame costs nothing.
+    f32 SentVolume[AUDIO_MAX_CHANNELS];
+    f32 PendingVolume[AUDIO_MAX_CHANNELS];
+    bool HasPushed;
+
+    // Head only moves on the game thread and Tail only on the audio thread.
+    AudioCommand Commands[AUDIO_QUEUE_CAPACITY];
+    std::atomic<u32> Head;
+    std::atomic<u32> Tail;
+
+    std::atomic<bool> IsRunning;
+    SDL_sem* Wake;
+    SDL_Thread* Thread;
+};
+
+static void audio_load(PlatformAudio* audio, AudioSoundSlot& slot) {
+    bool isBorrowed = slot.Memory != nullptr;
+    size_t size = slot.MemorySize;
+    const u8* data = slot.Memory;
+    if (!isBorrowed) {
+        data = audio_map_file(slot.Path, &size);
+        if (!data) {
+            CX_ERROR("Failed to open %s.", slot.Path);
+            return;
+        }
+    }
+
+    SoLoud::AudioSource* source;
+    SoLoud::result result;
+    if (slot.IsStream) {
+        SoLoud::WavStream* stream = new SoLoud::WavStream();
+        result = stream->loadMem(data, (u32)size, false, false);
+        source = stream;
+    } else {
+        AudioSample* sample = new AudioSample();
+        result = sample->loadMem(data, (u32)size, false, false);
+        source = sample;
+    }
+
+    if (result != SoLoud::SO_NO_ERROR) {
+        CX_ERROR("Failed to load %s: %s.", slot.Path, audio->Engine.getErrorString(result));
+        delete source;
+        if (!isBorrowed) {
+            audio_unmap_file(data, size);
+        }
+        return;
+    }
+
+    if (isBorrowed) {
+        // Nothing to release, the memory outlives the sound.
+    } else if (slot.IsStream) {
+        slot.Mapping = data;
+        slot.MappingSize = size;
+    } else {
+        audio_unmap_file(data, size);
+    }
+
+    source->setLooping(slot.IsLooping);
+    slot.Source = source;
+}
+
+/*
+    Runs sfxr once into a PCM buffer that the sample then owns, so playing it is the same as
+    playing a decoded file rather than running the synth live on every voice.
+*/
+
+static void audio_synthesise(AudioSoundSlot& slot) {
+    SoLoud::Sfxr sfxr;
+    sfxr.loadPreset(slot.Synth.Preset, (i32)slot.Synth.Seed);
+
+    SoLoud::SfxrParams& params = sfxr.mParams;
+    params.p_base_freq = Clamp(params.p_base_freq + slot.Synth.Pitch, 0.0f, 1.0f);
+    params.p_env_sustain *= slot.Synth.Length;
+    params.p_env_decay *= slot.Synth.Length;
+
+    const u32 maxSamples = AUDIO_SYNTH_SAMPLE_RATE * AUDIO_SYNTH_MAX_SECONDS;
+    const u32 chunk = 512;
+    f32* samples = new f32[maxSamples];
+    u32 count = 0;
+
+    SoLoud::AudioSourceInstance* instance = sfxr.createInstance();
+    while (count < maxSamples && !instance->hasEnded()) {
+        u32 toRead = maxSamples - count < chunk ? maxSamples - count : chunk;
+        count += instance->getAudio(samples + count, toRead, toRead);
+    }
+    delete instance;
+
+    AudioSample* sample = new AudioSample();
+    sample->loadRawWave(samples, count, AUDIO_SYNTH_SAMPLE_RATE, 1, false, true);
+    slot.Source = sample;
+}
+
+/*
+    A free voice from the pool, or failing that the one that has been playing longest.
+*/
+
+static u32 audio_claim_voice(PlatformAudio* audio) {
+    u32 oldest = 0;
+    for (u32 i = 0; i < AUDIO_MAX_VOICES; i++) {
+        if (!audio->Engine.isValidVoiceHandle(audio->Voices[i])) {
+            return i;
+        }
+        if (audio->VoiceStarted[i] < audio->VoiceStarted[oldest]) {
+            oldest = i;
+        }
+    }
+    audio->Engine.stop(audio->Voices[oldest]);
+    return oldest;
+}
+
+static void audio_execute(PlatformAudio* audio, const AudioCommand& command) {
+    switch (command.Type) {
+        case AudioCommandType::Load: {
+            AudioSoundSlot& slot = audio->Sounds[command.Sound];
+            if (slot.IsSynth) {
+                audio_synthesise(slot);
+            } else {
+                audio_load(audio, slot);
+            }
+        } break;
+
+        case AudioCommandType::Play: {
+            SoLoud::AudioSource* source = audio->Sounds[command.Sound].Source;
+            if (!source) {
+                break;
+            }
+
+            if (command.Channel != AUDIO_CHANNEL_NONE) {
+                audio->Engine.stop(audio->Channels[command.Channel]);
+                audio->Channels[command.Channel] = audio->Engine.play(*source, command.Volume);
+            } else {
+                u32 voice = audio_claim_voice(audio);
+                audio->Voices[voice] = audio->Engine.play(*source, command.Volume);
+                audio->VoiceStarted[voice] = audio->PlayCount++;
+            }
+        } break;
+
+        case AudioCommandType::SetVolume: {
+            audio->Engine.setVolume(audio->Channels[command.Channel], command.Volume);
+        } break;
+
+        case AudioCommandType::Stop: {
+            audio->Engine.stop(audio->Channels[command.Channel]);
+            audio->Channels[command.Channel] = 0;
+        } break;
+    }
+}
+
+static void audio_drain(PlatformAudio* audio) {
+    u32 tail = audio->Tail.load(std::memory_order_relaxed);
+    u32 head = audio->Head.load(std::memory_order_acquire);
+    while (tail != head) {
+        audio_execute(audio, audio->Commands[tail % AUDIO_QUEUE_CAPACITY]);
+        tail++;
+    }
+    audio->Tail.store(tail, std::memory_order_release);
+}
+
+static void audio_push(PlatformAudio* audio, const AudioCommand& command) {
+    u32 head = audio->Head.load(std::memory_order_relaxed);
+    if (head - audio->Tail.load(std::memory_order_acquire) == AUDIO_QUEUE_CAPACITY) {
+        CX_WARN("Audio command queue is full, dropping a command.");
+        return;
+    }
+    audio->Commands[head % AUDIO_QUEUE_CAPACITY] = command;
+    audio->Head.store(head + 1, std::memory_order_release);
+    audio->HasPushed = true;
+}
+
+#if !CORTEX_PLATFORM_WEB
+static i32 audio_thread_main(void* userData) {
+    PlatformAudio* audio = (PlatformAudio*)userData;
+    while (audio->IsRunning.load(std::memory_order_acquire)) {
+        SDL_SemWait(audio->Wake);
+        audio_drain(audio);
+    }
+    return 0;
+}
+#endif
+
+PlatformAudio* audio_create() {
+    PlatformAudio* audio = new PlatformAudio();
+    audio->Engine.init();
+
+    audio->Head = 0;
+    audio->Tail = 0;
+    for (u32 i = 0; i < AUDIO_MAX_CHANNELS; i++) {
+        audio->SentVolume[i] = -1.0f;
+        audio->PendingVolume[i] = -1.0f;
+    }
+
+#if !CORTEX_PLATFORM_WEB
+    audio->IsRunning = true;
+    audio->Wake = SDL_CreateSemaphore(0);
+    audio->Thread = SDL_CreateThread(audio_thread_main, "Audio", audio);
+    CX_ASSERT(audio->Thread != NULL, "Failed to start the audio thread.");
+#endif
+
+    return audio;
+}
+
+void audio_destroy(PlatformAudio* audio) {
+#if !CORTEX_PLATFORM_WEB
+    audio->IsRunning.store(false, std::memory_order_release);
+    SDL_SemPost(audio->Wake);
+    SDL_WaitThread(audio->Thread, NULL);
+    SDL_DestroySemaphore(audio->Wake);
+#endif
+
+    // Sources stop their voices as they go, so they go before the engine.
+    for (u32 i = 0; i < audio->SoundCount; i++) {
+        AudioSoundSlot& slot = audio->Sounds[i];
+        delete slot.Source;
+        if (slot.Mapping) {
+            audio_unmap_file(slot.Mapping, slot.MappingSize);
+        }
+    }
+    audio->Engine.deinit();
+    delete audio;
+}
+
+static AudioSoundSlot* audio_add_sound(PlatformAudio* audio, const char* name, AudioSound* sound) {
+    if (audio->SoundCount == AUDIO_MAX_SOUNDS) {
+        CX_ERROR("Too many sounds to load %s.", name);
+        return nullptr;
+    }
+
+    *sound = (AudioSound)audio->SoundCount++;
+    AudioSoundSlot& slot = audio->Sounds[*sound];
+    snprintf(slot.Path, sizeof(slot.Path), "%s", name);
+    return &slot;
+}
+
+static void audio_queue_load(PlatformAudio* audio, AudioSound sound) {
+    AudioCommand command = {};
+    command.Type = AudioCommandType::Load;
+    command.Sound = sound;
+    audio_push(audio, command);
+}
+
+/*
+    Queues a sound to load on the audio thread and returns its index straight away, so nothing
+    is read or decoded on the game thread. Sound effects (isStream false) are decoded whole;
+    streams decode as they play, from the mapped file. Plays queued after the load wait for it,
+    and a sound that fails to load plays as silence.
+*/
+
+AudioSound audio_load_sound(PlatformAudio* audio, const char* path, bool isStream, bool isLooping) {
+    AudioSound sound;
+    AudioSoundSlot* slot = audio_add_sound(audio, path, &sound);
+    if (!slot) {
+        return AUDIO_SOUND_NONE;
+    }
+
+    slot->IsStream = isStream;
+    slot->IsLooping = isLooping;
+    audio_queue_load(audio, sound);
+    return sound;
+}
+
+/*
+    As audio_load_sound, but decoding from memory that stays valid until audio_destroy, such as
+    an asset in the archive. Nothing is copied: streams decode straight out of it as they play.
+*/
+
+AudioSound audio_load_sound_memory(PlatformAudio* audio, const char* name, const u8* data, size_t size, bool isStream, bool isLooping) {
+    AudioSound sound;
+    AudioSoundSlot* slot = audio_add_sound(audio, name, &sound);
+    if (!slot) {
+        return AUDIO_SOUND_NONE;
+    }
+
+    slot->IsStream = isStream;
+    slot->IsLooping = isLooping;
+    slot->Memory = data;
+    slot->MemorySize = size;
+    audio_queue_load(audio, sound);
+    return sound;
+}
+
+/*
+    Queues a sound effect to be synthesised on the audio thread, see AudioSynth. Like
+    audio_load_sound, the index is good to play straight away.
+*/
+
+AudioSound audio_synth_sound(PlatformAudio* audio, const AudioSynth& synth) {
+    AudioSound sound;
+    AudioSoundSlot* slot = audio_add_sound(audio, "synthesised sound", &sound);
+    if (!slot) {
+        return AUDIO_SOUND_NONE;
+    }
+
+    slot->IsSynth = true;
+    slot->Synth = synth;
+    audio_queue_load(audio, sound);
+    return sound;
+}
+
+void audio_play(PlatformAudio* audio, AudioSound sound, u8 channel, f32 volume) {
+    if (sound == AUDIO_SOUND_NONE) {
+        return;
+    }
+
+    if (channel != AUDIO_CHANNEL_NONE) {
+        audio->SentVolume[channel] = volume;
+        audio->PendingVolume[channel] = volume;
+    }
+
+    AudioCommand command = {};
+    command.Type = AudioCommandType::Play;
+    command.Channel = channel;
+    command.Sound = sound;
+    command.Volume = volume;
+    audio_push(audio, command);
+}
+
+void audio_set_volume(PlatformAudio* audio, u8 channel, f32 volume) {
+    audio->PendingVolume[channel] = volume;
+}
+
+void audio_stop(PlatformAudio* audio, u8 channel) {
+    AudioCommand command = {};
+    command.Type = AudioCommandType::Stop;
+    command.Channel = channel;
+    audio_push(audio, command);
+}
+
+/*
+    Called once a frame after the game has updated: sends the volume changes that actually
+    change something and wakes the audio thread if there is anything for it to do.
+*/
+
+void audio_flush(PlatformAudio* audio) {
+    for (u32 i = 0; i < AUDIO_MAX_CHANNELS; i++) {
+        if (audio->PendingVolume[i] != audio->SentVolume[i]) {
+            AudioCommand command = {};
+            command.Type = AudioCommandType::SetVolume;
+            command.Channel = (u8)i;
+            command.Volume = audio->PendingVolume[i];
+            audio_push(audio, command);
+            audio->SentVolume[i] = audio->PendingVolume[i];
+        }
+    }
+
+    if (!audio->HasPushed) {
+        return;
+    }
+    audio->HasPushed = false;
+
+#if CORTEX_PLATFORM_WEB
+    audio_drain(audio);
+#else
+    SDL_SemPost(audio->Wake);
+#endif
+}
@@ -0,0 +1,65 @@
+#pragma once
+
+#include "core/base.h"
+
+/*
+    Platform audio. The game never calls SoLoud itself: play, volume and stop requests go into a
+    single-producer, single-consumer ring of commands that the audio thread drains and hands to
+    SoLoud, so SoLoud's mutex is only ever taken off the game thread. On the web, where there
+    are no threads, audio_flush drains the ring itself at the end of the frame.
+
+    Sounds load on the audio thread too and are referred to by index. A sound that needs
+    adjusting or stopping later is played on a channel, a slot the game picks that stands in for
+    the SoLoud voice handle, which the game thread never sees. Everything else plays on one of
+    a fixed pool of voices, taking over the oldest when they are all busy.
+*/
+
+#define AUDIO_MAX_SOUNDS 32
+#define AUDIO_MAX_CHANNELS 8
+#define AUDIO_MAX_VOICES 8
+#define AUDIO_PATH_LENGTH 128
+#define AUDIO_QUEUE_CAPACITY 256
+
+#define AUDIO_SOUND_NONE 0xffff
+#define AUDIO_CHANNEL_NONE 0xff // Play and forget, nothing can change it afterwards.
+
+typedef u16 AudioSound;
+
+/*
+    A sound effect synthesised with sfxr instead of loaded: one of sfxr's presets, randomised
+    from a fixed seed so it comes out the same every run, then nudged in pitch and length.
+*/
+
+enum AudioSynthPreset : u8 {
+    AUDIO_SYNTH_COIN,
+    AUDIO_SYNTH_LASER,
+    AUDIO_SYNTH_EXPLOSION,
+    AUDIO_SYNTH_POWERUP,
+    AUDIO_SYNTH_HURT,
+    AUDIO_SYNTH_JUMP,
+    AUDIO_SYNTH_BLIP,
+};
+
+struct AudioSynth {
+    AudioSynthPreset Preset;
+    u32 Seed;
+    f32 Pitch;  // Added to the preset's base frequency, which runs from 0 to 1.
+    f32 Length; // Scales the preset's sustain and decay.
+};
+
+#define AUDIO_SYNTH_SAMPLE_RATE 44100
+#define AUDIO_SYNTH_MAX_SECONDS 2
+
+struct PlatformAudio;
+
+PlatformAudio* audio_create();
+void audio_destroy(PlatformAudio* audio);
+
+AudioSound audio_load_sound(PlatformAudio* audio, const char* path, bool isStream, bool isLooping);
+AudioSound audio_load_sound_memory(PlatformAudio* audio, const char* name, const u8* data, size_t size, bool isStream, bool isLooping);
+AudioSound audio_synth_sound(PlatformAudio* audio, const AudioSynth& synth);
+
+void audio_play(PlatformAudio* audio, AudioSound sound, u8 channel, f32 volume);
+void audio_set_volume(PlatformAudio* audio, u8 channel, f32 volume);
+void audio_stop(PlatformAudio* audio, u8 channel);
+void audio_flush(PlatformAudio* audio);
@@ -3,6 +3,9 @@
 #include <iostream>
 #include <string>
 #include <memory>
+#include <cstring>
+#include <cstdarg>
+#include <cstdio>
 #include <assert.h>
 
 #define STATIC_ASSERT static_assert
@@ -58,8 +61,11 @@ STATIC_ASSERT(sizeof(f64) == 8, "Expected f64 to be 8 byte(s).");
     #endif
 #elif defined(__EMSCRIPTEN__)
     #define CORTEX_PLATFORM_WEB 1
+#elif defined(__linux__)
+    #define CORTEX_PLATFORM_LINUX 1
+    // Desktop game (SDL2) and the headless tools.
 #else
-    #error "Cortex only supports Apple platforms at this time."
+    #error "Cortex only supports Apple, Linux and Web platforms at this time."
 #endif
 
 #ifndef CORTEX_PLATFORM_APPLE
@@ -74,6 +80,10 @@ STATIC_ASSERT(sizeof(f64) == 8, "Expected f64 to be 8 byte(s).");
     #define CORTEX_PLATFORM_WEB 0
 #endif
 
+#ifndef CORTEX_PLATFORM_LINUX
+    #define CORTEX_PLATFORM_LINUX 0
+#endif
+
 typedef enum LogLevel {
     LOG_LEVEL_FATAL = 0,
     LOG_LEVEL_ERROR = 1,
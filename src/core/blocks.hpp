@@ -0,0 +1,47 @@
+#pragma once
+
+#include "core/base.h"
+#include "core/field.hpp"
+#include "core/palette.hpp"
+#include "core/platform.hpp"
+
+/*
+    Blocks are drawn from a skin: one texture holding a pre-rendered tile for every block colour
+    in each style a cell can be drawn in, so a block is a single textured quad however it looks.
+    Quads are gathered into a BlockBatch over the frame and the lot goes out in one
+    SDL_RenderGeometry call.
+*/
+
+#define BLOCK_SIZE 32
+
+// Tile columns, one per palette index up to and including the walls.
+#define BLOCK_SKIN_COLORS (PALETTE_WALLS + 1)
+
+enum BlockStyle : u8 {
+    BLOCK_STYLE_EMPTY,  // Shaded, no outline. Empty field cells.
+    BLOCK_STYLE_LOCKED, // Outlined and shaded. Pieces placed in the field.
+    BLOCK_STYLE_SOLID,  // Outlined. Walls and pieces still in play.
+    BLOCK_STYLE_COUNT
+};
+
+struct BlockSkin {
+    SDL_Texture* Atlas;
+    i32 Width;
+    i32 Height;
+};
+
+// Enough for the field and its walls, plus the active and preview pieces.
+#define BLOCK_BATCH_CAPACITY (FIELD_SIZE + 2 * FIELD_HEIGHT + 32)
+
+struct BlockBatch {
+    SDL_Vertex Vertices[BLOCK_BATCH_CAPACITY * 4];
+    i32 Indices[BLOCK_BATCH_CAPACITY * 6];
+    u32 Count;
+};
+
+bool block_skin_create(SDL_Renderer* renderer, BlockSkin* skin);
+void block_skin_destroy(BlockSkin* skin);
+
+void block_batch_init(BlockBatch* batch);
+void block_batch_add(BlockBatch* batch, const BlockSkin* skin, u8 color, BlockStyle style, f32 x, f32 y);
+void block_batch_draw(SDL_Renderer* renderer, const BlockSkin* skin, BlockBatch* batch);
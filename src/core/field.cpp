@@ -10,14 +10,14 @@ void field_set_cell(u32* field, u32 row, u32 col, u32 value) {
     field[(row * FIELD_WIDTH) + col] = value;
 }
 
-bool field_check_collision(u32* field, Shape shape, i32 shapeX, i32 shapeY) {
+bool field_check_collision(const u32* field, const Shape& shape, i32 shapeX, i32 shapeY) {
     for (i32 i = 0; i < 4; i++) {
         for (i32 j = 0; j < 4; j++) {
             i32 row = (3 - j) + shapeY;
             i32 col = i + shapeX;
             bool isBoundary = (col >= FIELD_WIDTH || col < 0) || (row < 0);
             bool fieldVal = isBoundary;
-            if (row < FIELD_HEIGHT) {
+            if (!isBoundary && row < FIELD_HEIGHT) {
                 fieldVal |= (bool)(field[row * FIELD_WIDTH + col]);
             }
             bool collision = (bool)shape.Data[(j * 4) + i] && fieldVal;
@@ -29,19 +29,20 @@ bool field_check_collision(u32* field, Shape shape, i32 shapeX, i32 shapeY) {
     return false;
 }
 
-void field_place_shape(u32* field, Shape shape, i32 shapeX, i32 shapeY) {
+void field_place_shape(u32* field, const Shape& shape, i32 shapeX, i32 shapeY) {
     for (i32 i = 0; i < 4; i++) {
         for (i32 j = 0; j < 4; j++) { 
             i32 row = (3 - j) + shapeY;
             i32 col = i + shapeX; 
-            if (shape.Data[(j * 4) + i]) {
+            // Cells landing above the top of the field are lost rather than written out of bounds.
+            if (shape.Data[(j * 4) + i] && row < FIELD_HEIGHT) {
                 field_set_cell(field, row, col, shape.ID);
             }
         }
     }
 }
 
-bool field_check_line(u32* field, u32 row) {
+bool field_check_line(const u32* field, u32 row) {
     bool isFull = true;
     for (i32 i = 0; i < FIELD_WIDTH; i++) {
         if (!field[row * FIELD_WIDTH + i]) {
@@ -52,26 +53,62 @@ bool field_check_line(u32* field, u32 row) {
     return isFull;
 }
 
-u32 field_clear_lines(u32* field) {
-    u32 count = 0;
-    for (i32 j = FIELD_HEIGHT - 1; j >= 0; j--) {
-        if (field_check_line(field, j)) {
-            // Delete the line and move everything down to adjust.
-            // Iterate upwards setting each row to the value of the row above.
-            for (i32 row = j; row < FIELD_HEIGHT - 1; row++) {
-                memcpy(&field[row * FIELD_WIDTH], &field[(row + 1) * FIELD_WIDTH], sizeof(u32) * FIELD_WIDTH);
-            }
-            // Zero out the top row to simulate pulling an empty row from above.
-            memset(&field[(FIELD_HEIGHT - 1) * FIELD_WIDTH], 0, sizeof(u32) * FIELD_WIDTH);
+/*
+    Single pass from the bottom: rows that are not full are copied down over the ones that were,
+    then the rows left at the top are zeroed, as if empty rows were pulled in from above. If
+    clearedRows is given it gets a bit for each row that was full, numbered from the bottom as
+    they were before the clear.
+*/
 
-            // Increment linecount for scoring.
-            count ++;
+u32 field_clear_lines(u32* field, u32* clearedRows) {
+    u32 kept = 0;
+    u32 cleared = 0;
+    for (u32 row = 0; row < FIELD_HEIGHT; row++) {
+        if (field_check_line(field, row)) {
+            cleared |= 1u << row;
+            continue;
         }
+        if (kept != row) {
+            memcpy(&field[kept * FIELD_WIDTH], &field[row * FIELD_WIDTH], sizeof(u32) * FIELD_WIDTH);
+        }
+        kept++;
+    }
+
+    u32 count = FIELD_HEIGHT - kept;
+    memset(&field[kept * FIELD_WIDTH], 0, sizeof(u32) * FIELD_WIDTH * count);
+    if (clearedRows) {
+        *clearedRows = cleared;
     }
     return count;
 }
 
-f32 field_fill_factor(u32* field) {
+/*
+    Pushes the stack up by rowCount rows and fills the rows that open up at the bottom with
+    `value`, except for holeColumn. Returns true if any filled cell was pushed off the top.
+*/
+
+bool field_insert_garbage(u32* field, u32 rowCount, u32 holeColumn, u32 value) {
+    CX_DEBUGASSERT(holeColumn < FIELD_WIDTH, "Garbage hole outside the field!");
+    rowCount = rowCount < FIELD_HEIGHT ? rowCount : FIELD_HEIGHT;
+    if (rowCount == 0) {
+        return false;
+    }
+
+    bool overflow = false;
+    for (u32 i = (FIELD_HEIGHT - rowCount) * FIELD_WIDTH; i < FIELD_SIZE; i++) {
+        overflow |= field[i] != 0;
+    }
+
+    memmove(&field[rowCount * FIELD_WIDTH], field, sizeof(u32) * FIELD_WIDTH * (FIELD_HEIGHT - rowCount));
+    for (u32 row = 0; row < rowCount; row++) {
+        for (u32 col = 0; col < FIELD_WIDTH; col++) {
+            field[row * FIELD_WIDTH + col] = col == holeColumn ? 0 : value;
+        }
+    }
+    return overflow;
+}
+
+f32 field_fill_factor(const u32* field) {
     u32 count = 0;
     for (i32 i = 0; i < FIELD_SIZE; i++) {
         if (field[i]) {
@@ -79,4 +116,19 @@ f32 field_fill_factor(u32* field) {
         }
     }
     return (f32)count / (f32)(FIELD_SIZE);
-}
\ No newline at end of file
+}
+
+/*
+    Packs the field into one bitmask per row (bit c is column c, row 0 first), 36 bytes instead
+    of 720, which is what datasets and bot observations store.
+*/
+
+void field_to_rows(const u32* field, u16* rows) {
+    for (i32 row = 0; row < FIELD_HEIGHT; row++) {
+        u16 mask = 0;
+        for (i32 col = 0; col < FIELD_WIDTH; col++) {
+            mask |= (u16)((field[row * FIELD_WIDTH + col] != 0) << col);
+        }
+        rows[row] = mask;
+    }
+}
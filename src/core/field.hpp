@@ -12,8 +12,10 @@ struct Shape;
 
 void field_clear(u32* field);
 void field_set_cell(u32* field, u32 row, u32 col, u32 value);
-bool field_check_collision(u32* field, Shape shape, i32 shapeX, i32 shapeY);
-void field_place_shape(u32* field, Shape shape, i32 shapeX, i32 shapeY);
-bool field_check_line(u32* field, u32 row);
-u32 field_clear_lines(u32* field);
-f32 field_fill_factor(u32* field);
\ No newline at end of file
+bool field_check_collision(const u32* field, const Shape& shape, i32 shapeX, i32 shapeY);
+void field_place_shape(u32* field, const Shape& shape, i32 shapeX, i32 shapeY);
+bool field_check_line(const u32* field, u32 row);
+u32 field_clear_lines(u32* field, u32* clearedRows);
+bool field_insert_garbage(u32* field, u32 rowCount, u32 holeColumn, u32 value);
+f32 field_fill_factor(const u32* field);
+void field_to_rows(const u32* field, u16* rows);
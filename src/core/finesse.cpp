@@ -0,0 +1,202 @@
+#include "core/finesse.hpp"
+
+struct FinesseState {
+    u8 Rotation;
+    i8 X;
+};
+
+struct FinesseTable {
+    FinessePath Paths[SHAPE_COUNT][SHAPE_ROTATION_COUNT][SHAPE_ROTATION_COUNT][FINESSE_COLUMN_COUNT];
+};
+
+// Where a move from (rotation, x) at the spawn height ends up on the empty field, or false if it is blocked.
+static bool finesse_apply(const u32* field, u32 shapeID, FinesseState state, FinesseInput input, FinesseState* result) {
+    *result = state;
+    switch (input) {
+        case FinesseInput::RotateCW:
+            result->Rotation = (u8)((state.Rotation + 1) % SHAPE_ROTATION_COUNT);
+            break;
+        case FinesseInput::TapLeft:
+        case FinesseInput::HoldLeft:
+            result->X = (i8)(state.X - 1);
+            break;
+        case FinesseInput::TapRight:
+        case FinesseInput::HoldRight:
+            result->X = (i8)(state.X + 1);
+            break;
+    }
+    if (field_check_collision(field, shape_get_rotated(shapeID, result->Rotation), result->X, SIM_SPAWN_Y)) {
+        return false;
+    }
+
+    // Holding keeps sliding until the wall.
+    if (input == FinesseInput::HoldLeft || input == FinesseInput::HoldRight) {
+        i32 dx = input == FinesseInput::HoldLeft ? -1 : 1;
+        while (!field_check_collision(field, shape_get_rotated(shapeID, result->Rotation), result->X + dx, SIM_SPAWN_Y)) {
+            result->X = (i8)(result->X + dx);
+        }
+    }
+    return true;
+}
+
+// Cells a hard drop from (rotation, x) fills on the empty field, the bottom four rows packed as in the perfect-clear solver.
+static u64 finesse_footprint(const u32* field, u32 shapeID, u32 rotation, i32 x) {
+    const Shape& shape = shape_get_rotated(shapeID, rotation);
+    i32 y = SIM_SPAWN_Y;
+    while (!field_check_collision(field, shape, x, y - 1)) {
+        y--;
+    }
+
+    u64 cells = 0;
+    for (i32 i = 0; i < 4; i++) {
+        for (i32 j = 0; j < 4; j++) {
+            if (shape.Data[(j * 4) + i]) {
+                // Same (row, col) mapping as field_place_shape.
+                cells |= (u64)1 << (((3 - j) + y) * FIELD_WIDTH + i + x);
+            }
+        }
+    }
+    return cells;
+}
+
+/*
+    One breadth-first search per piece and start rotation over the 4 x 13 (rotation, column)
+    states at the spawn height. Afterwards every placement takes the shortest path of any
+    (rotation, column) that drops into the same cells, since the S, Z and I pieces reach each
+    landing from two rotations.
+*/
+
+static FinesseTable finesse_build_table() {
+    FinesseTable table;
+    u32 field[FIELD_SIZE];
+    field_clear(field);
+
+    for (u32 id = 1; id < SHAPE_COUNT; id++) {
+        for (u32 start = 0; start < SHAPE_ROTATION_COUNT; start++) {
+            FinessePath (&paths)[SHAPE_ROTATION_COUNT][FINESSE_COLUMN_COUNT] = table.Paths[id][start];
+            for (u32 r = 0; r < SHAPE_ROTATION_COUNT; r++) {
+                for (u32 c = 0; c < FINESSE_COLUMN_COUNT; c++) {
+                    paths[r][c].Count = FINESSE_UNREACHABLE;
+                }
+            }
+
+            FinesseState queue[SHAPE_ROTATION_COUNT * FINESSE_COLUMN_COUNT];
+            u32 head = 0;
+            u32 tail = 0;
+            queue[tail++] = { (u8)start, (i8)SIM_SPAWN_X };
+            paths[start][SIM_SPAWN_X - SIM_MIN_X].Count = 0;
+
+            while (head < tail) {
+                FinesseState state = queue[head++];
+                const FinessePath& path = paths[state.Rotation][state.X - SIM_MIN_X];
+                for (u32 input = 0; input <= (u32)FinesseInput::HoldRight; input++) {
+                    FinesseState next;
+                    if (!finesse_apply(field, id, state, (FinesseInput)input, &next)) {
+                        continue;
+                    }
+                    FinessePath& nextPath = paths[next.Rotation][next.X - SIM_MIN_X];
+                    if (nextPath.Count != FINESSE_UNREACHABLE || path.Count == FINESSE_MAX_INPUTS) {
+                        continue;
+                    }
+                    nextPath = path;
+                    nextPath.Inputs[nextPath.Count++] = (FinesseInput)input;
+                    queue[tail++] = next;
+                }
+            }
+
+            u64 footprints[SHAPE_ROTATION_COUNT][FINESSE_COLUMN_COUNT];
+            for (u32 r = 0; r < SHAPE_ROTATION_COUNT; r++) {
+                for (u32 c = 0; c < FINESSE_COLUMN_COUNT; c++) {
+                    bool isReachable = paths[r][c].Count != FINESSE_UNREACHABLE;
+                    footprints[r][c] = isReachable ? finesse_footprint(field, id, r, (i32)c + SIM_MIN_X) : 0;
+                }
+            }
+
+            FinessePath best[SHAPE_ROTATION_COUNT][FINESSE_COLUMN_COUNT];
+            memcpy(best, paths, sizeof(best));
+            for (u32 r = 0; r < SHAPE_ROTATION_COUNT; r++) {
+                for (u32 c = 0; c < FINESSE_COLUMN_COUNT; c++) {
+                    for (u32 r2 = 0; r2 < SHAPE_ROTATION_COUNT && footprints[r][c]; r2++) {
+                        for (u32 c2 = 0; c2 < FINESSE_COLUMN_COUNT; c2++) {
+                            if (footprints[r2][c2] == footprints[r][c] && paths[r2][c2].Count < best[r][c].Count) {
+                                best[r][c] = paths[r2][c2];
+                            }
+                        }
+                    }
+                }
+            }
+            memcpy(paths, best, sizeof(best));
+        }
+    }
+    return table;
+}
+
+const FinessePath& finesse_get_path(u32 shapeID, u32 startRotation, u32 rotation, i32 x) {
+    static const FinesseTable s_Table = finesse_build_table();
+    CX_DEBUGASSERT(x >= SIM_MIN_X && x <= SIM_MAX_X, "Column out of range!");
+    return s_Table.Paths[shapeID][startRotation][rotation][x - SIM_MIN_X];
+}
+
+const char* finesse_input_name(FinesseInput input) {
+    switch (input) {
+        case FinesseInput::RotateCW: return "rotate";
+        case FinesseInput::TapLeft: return "left";
+        case FinesseInput::TapRight: return "right";
+        case FinesseInput::HoldLeft: return "hold left";
+        case FinesseInput::HoldRight: return "hold right";
+    }
+    return "unknown";
+}
+
+/*
+    A placement is judged only if it is exactly where a hard drop from the spawn height lands,
+    with the piece free to be there at the top of the field.
+*/
+
+bool finesse_is_judgeable(const u32* field, u32 shapeID, u32 rotation, i32 x, i32 y) {
+    if (x < SIM_MIN_X || x > SIM_MAX_X) {
+        return false;
+    }
+    const Shape& shape = shape_get_rotated(shapeID, rotation);
+    if (field_check_collision(field, shape, x, SIM_SPAWN_Y)) {
+        return false;
+    }
+    i32 landing = SIM_SPAWN_Y;
+    while (!field_check_collision(field, shape, x, landing - 1)) {
+        landing--;
+    }
+    return landing == y;
+}
+
+/*
+    Rebuilds the field piece by piece, judging each placement against the table before it locks.
+*/
+
+FinesseReport finesse_analyse(const ReplayPiece* pieces, u32 count) {
+    FinesseReport report = {};
+    u32 field[FIELD_SIZE];
+    field_clear(field);
+
+    for (u32 i = 0; i < count; i++) {
+        const ReplayPiece& piece = pieces[i];
+        if (piece.ShapeID == 0 || piece.ShapeID >= SHAPE_COUNT) {
+            continue;
+        }
+        report.Pieces++;
+
+        if (finesse_is_judgeable(field, piece.ShapeID, piece.Rotation, piece.X, piece.Y)) {
+            const FinessePath& path = finesse_get_path(piece.ShapeID, piece.StartRotation, piece.Rotation, piece.X);
+            if (path.Count != FINESSE_UNREACHABLE) {
+                u32 presses = piece.RotatePresses + piece.MovePresses;
+                report.Judged++;
+                report.Presses += presses;
+                report.OptimalPresses += path.Count;
+                report.Faults += presses > path.Count;
+            }
+        }
+
+        field_place_shape(field, shape_get_rotated(piece.ShapeID, piece.Rotation), piece.X, piece.Y);
+        field_clear_lines(field, nullptr);
+    }
+    return report;
+}
@@ -0,0 +1,46 @@
+#pragma once
+
+#include "core/base.h"
+#include "core/sim.hpp"
+#include "core/replay.hpp"
+
+/*
+    Finesse: the fewest key presses that take a piece from the spawn to a placement, using the
+    moves the game has (clockwise rotation, a tap left or right, or holding left or right until
+    the piece stops, which costs one press however far it goes). Computed once per piece, start
+    rotation, rotation and column by a breadth-first search on the empty field, so judging a
+    recorded placement is a table lookup.
+
+    Placements that land somewhere else than a hard drop from the top would (tucks under
+    overhangs) can't be reached with these moves alone and are not judged.
+*/
+
+#define FINESSE_MAX_INPUTS 7
+#define FINESSE_COLUMN_COUNT (SIM_MAX_X - SIM_MIN_X + 1)
+#define FINESSE_UNREACHABLE 0xff
+
+enum class FinesseInput : u8 {
+    RotateCW,
+    TapLeft,
+    TapRight,
+    HoldLeft,
+    HoldRight
+};
+
+struct FinessePath {
+    u8 Count; // FINESSE_UNREACHABLE if no sequence of inputs gets there.
+    FinesseInput Inputs[FINESSE_MAX_INPUTS];
+};
+
+struct FinesseReport {
+    u32 Pieces;
+    u32 Judged;
+    u32 Faults;
+    u32 Presses;         // Over judged pieces only.
+    u32 OptimalPresses;
+};
+
+const FinessePath& finesse_get_path(u32 shapeID, u32 startRotation, u32 rotation, i32 x);
+const char* finesse_input_name(FinesseInput input);
+bool finesse_is_judgeable(const u32* field, u32 shapeID, u32 rotation, i32 x, i32 y);
+FinesseReport finesse_analyse(const ReplayPiece* pieces, u32 count);
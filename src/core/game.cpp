@@ -2,116 +2,37 @@
 #include "core/platform.hpp"
 #include "maths/random.hpp"
 
-static Vec4 s_Colors[8] = {
-    COLOR_BACKGROUND,
-    {0.000, 0.378, 0.576, 1.0},
-    {0.004, 0.761, 0.706, 1.0},
-    {0.957, 0.612, 0.184, 1.0},
-    {0.914, 0.339, 0.227, 1.0},
-    {0.792, 0.055, 0.347, 1.0},
-    {0.812, 0.153, 0.890, 1.0},
-    {0.298, 0.886, 0.414, 1.0},
-};
+/*
+    Rendering procedures
+*/
 
-static Shape s_Shapes[8] = {
-    {
-        .Data = {
-            0, 0, 0, 0,
-            0, 0, 0, 0,
-            0, 0, 0, 0,
-            0, 0, 0, 0
-        },
-        .Color = s_Colors[0],
-        .ID = 0,        
-    },
-    {
-        .Data = {
-            0, 0, 0, 0,
-            1, 1, 1, 1,
-            0, 0, 0, 0,
-            0, 0, 0, 0
-        },
-        .Color = s_Colors[1],
-        .ID = 1,
-    },
-    {
-        .Data = {
-            0, 0, 0, 0,
-            0, 1, 1, 0,
-            0, 1, 1, 0,
-            0, 0, 0, 0
-        },
-        .Color = s_Colors[2],
-        .ID = 2,
-    },
-    {
-        .Data = {
-            0, 0, 0, 0,
-            0, 1, 0, 0,
-            0, 1, 1, 1,
-            0, 0, 0, 0
-        },
-        .Color = s_Colors[3],
-        .ID = 3,
-    },
-    {
-        .Data = {
-            0, 0, 0, 0,
-            0, 1, 1, 1,
-            0, 1, 0, 0,
-            0, 0, 0, 0
-        },
-        .Color = s_Colors[4],
-        .ID = 4,
-    },
-    {
-        .Data = {
-            0, 0, 0, 0,
-            0, 0, 1, 0,
-            0, 1, 1, 1,
-            0, 0, 0, 0
-        },
-        .Color = s_Colors[5],
-        .ID = 5,
-    },
-    {
-        .Data = {
-            0, 0, 0, 0,
-            0, 0, 1, 1,
-            0, 1, 1, 0,
-            0, 0, 0, 0
-        },
-        .Color = s_Colors[6],
-        .ID = 6,
-    },
-    {
-        .Data = {
-            0, 0, 0, 0,
-            0, 1, 1, 0,
-            0, 0, 1, 1,
-            0, 0, 0, 0
-        },
-        .Color = s_Colors[7],
-        .ID = 7,
-    },
-};
+/*
+    Blocks go into context->Game->Blocks rather than straight to the renderer, and are drawn
+    all at once by block_batch_draw after the field and preview have added theirs.
+*/
 
-static u32 s_LineClearScores[5] = {
-    0,   // No clear
-    100, // Single
-    300, // Double
-    500, // Triple
-    800  // Tetris
-};
+static void game_add_block(Context* context, u8 color, BlockStyle style, i32 x, i32 y) {
+    block_batch_add(&context->Game->Blocks, &context->Game->Skin, color, style, (f32)x, (f32)y);
+}
 
 /*
-    Rendering procedures
+    Adds the 128 x 128 shape, where (x, y) is the top-left corner
 */
 
+static void game_render_shape(Context* context, const Shape& shape, i32 x, i32 y) {
+    for (i32 j = 0; j < 4; j++) {
+        for (i32 i = 0; i < 4; i++) {
+            if (shape.Data[(j * 4) + i]) {
+                game_add_block(context, (u8)shape.ID, BLOCK_STYLE_SOLID, x + i * BLOCK_SIZE, y + j * BLOCK_SIZE);
+            }
+        }
+    }
+}
+
 static void game_render_background(Context* context) {
     draw_quad_filled(
         context->Renderer,
-        COLOR_BACKGROUND,
+        PALETTE_BACKGROUND,
         {0, 0, (f32)context->WindowWidth, (f32)context->WindowHeight}
     );
 }
@@ -123,156 +44,141 @@ static void game_render_decorations(Context* context) {
 static void game_render_field(Context* context, i32 left, i32 top) {
     // Draw the walls.
     for (i32 j = 0; j < FIELD_HEIGHT; j++) {
-        Rect2D rectLeft = Rect2D(left, top + (j * 32), 32, 32);
-        Rect2D rectRight = Rect2D(left + (FIELD_WIDTH + 1) * 32, top + (j * 32), 32, 32);
-        draw_quad_filled(context->Renderer, COLOR_WALLS, rectLeft);
-        draw_quad_filled(context->Renderer, COLOR_WALLS, rectRight);
-        draw_quad_outline(context->Renderer, {0.0, 0.0, 0.0, 0.4}, rectLeft);
-        draw_quad_outline(context->Renderer, {0.0, 0.0, 0.0, 0.4}, rectRight);
+        i32 y = top + (j * BLOCK_SIZE);
+        game_add_block(context, PALETTE_WALLS, BLOCK_STYLE_SOLID, left, y);
+        game_add_block(context, PALETTE_WALLS, BLOCK_STYLE_SOLID, left + (FIELD_WIDTH + 1) * BLOCK_SIZE, y);
     }
 
     // Draw the cells of the field.
     for (i32 j = 0; j < FIELD_HEIGHT; j++) {
         for (i32 i = 1; i <= FIELD_WIDTH; i++) {
-            u32 cell = context->Game->Field[j * FIELD_WIDTH + i - 1];
-            Rect2D rect = Rect2D(left + (i * 32), top + ((FIELD_HEIGHT - j - 1) * 32), 32, 32);
-            Vec4 color = s_Shapes[cell].Color;
-            draw_quad_filled(context->Renderer, color, rect);
-            if (cell) {
-                draw_quad_outline(context->Renderer, {0.0, 0.0, 0.0, 0.4}, rect);
-            }
-            draw_quad_filled(context->Renderer, {1.0, 1.0, 1.0, 0.1}, rect);
+            u32 cell = context->Game->Sim.Field[j * FIELD_WIDTH + i - 1];
+            BlockStyle style = cell ? BLOCK_STYLE_LOCKED : BLOCK_STYLE_EMPTY;
+            game_add_block(context, (u8)cell, style, left + (i * BLOCK_SIZE), top + ((FIELD_HEIGHT - j - 1) * BLOCK_SIZE));
         }
     }
 
     // Draw the players active shape.
-    f32 offsetX = (f32)((context->Game->PlayerX + 1) * 32);
-    f32 offsetY = (f32)((FIELD_HEIGHT - context->Game->PlayerY - 4) * 32);
-    shape_render(context->Renderer, context->Game->CurrentShape, offsetX, offsetY);
+    i32 offsetX = left + (context->Game->Sim.PlayerX + 1) * BLOCK_SIZE;
+    i32 offsetY = top + (FIELD_HEIGHT - context->Game->Sim.PlayerY - 4) * BLOCK_SIZE;
+    game_render_shape(context, context->Game->Sim.CurrentShape, offsetX, offsetY);
+}
+
+/*
+    Writes value in decimal, zero padded to at least minDigits, and returns the characters
+    written. Used instead of snprintf for the HUD, which only ever shows whole numbers.
+*/
+
+static u32 hud_write_number(char* out, u32 value, u32 minDigits) {
+    char digits[10];
+    u32 count = 0;
+    do {
+        digits[count++] = (char)('0' + value % 10);
+        value /= 10;
+    } while (value > 0);
+
+    u32 length = 0;
+    for (u32 i = count; i < minDigits; i++) {
+        out[length++] = '0';
+    }
+    while (count > 0) {
+        out[length++] = digits[--count];
+    }
+    return length;
+}
+
+static const HudText& game_score_text(Context* context) {
+    HudText& hud = context->Game->ScoreText;
+    u32 score = context->Game->Sim.Score;
+    if (hud.Value != score) {
+        memcpy(hud.Text, "score ", 6);
+        hud.Text[6 + hud_write_number(hud.Text + 6, score, 6)] = '\0';
+        hud.Value = score;
+        hud.Width = measure_text(context->Game->MainFontMedium, hud.Text);
+    }
+    return hud;
+}
+
+static const HudText& game_timer_text(Context* context) {
+    HudText& hud = context->Game->TimerText;
+    u32 seconds = context->Game->Sim.Ticks / GAME_TICK_RATE;
+    if (hud.Value != seconds) {
+        u32 length = hud_write_number(hud.Text, seconds / 60, 2);
+        hud.Text[length++] = ':';
+        length += hud_write_number(hud.Text + length, seconds % 60, 2);
+        hud.Text[length] = '\0';
+        hud.Value = seconds;
+        hud.Width = measure_text(context->Game->MainFontMedium, hud.Text);
+    }
+    return hud;
 }
 
 static void game_render_score(Context* context, i32 left, i32 top) {
-    char charBuf[64];
-    snprintf(charBuf, 64, "score %06d", context->Game->Score);
     draw_text(
         context->Renderer,
         context->Game->MainFontMedium,
-        charBuf,
-        COLOR_TEXT_DARK,
+        game_score_text(context).Text,
+        PALETTE_TEXT_DARK,
         left,
         top
     );
 }
 
 static void game_render_timer(Context* context, i32 left, i32 top) {
-    i32 mins = context->Game->ElapsedGameTime / 60;
-    i32 seconds = (i32)(context->Game->ElapsedGameTime) % 60;
-    char charBuf[64];
-    snprintf(charBuf, 64, "%02d:%02d", mins, seconds);
-    
+    const HudText& timer = game_timer_text(context);
+
     draw_text(
         context->Renderer,
         context->Game->MainFontMedium,
         "time",
-        COLOR_TEXT_DARK,
+        PALETTE_TEXT_DARK,
         left,
         top
     );
 
-    draw_text_right_aligned(
+    draw_text(
         context->Renderer,
         context->Game->MainFontMedium,
-        charBuf,
-        COLOR_TEXT_DARK,
-        left + 192,
+        timer.Text,
+        PALETTE_TEXT_DARK,
+        left + 192 - timer.Width,
         top
     );
 }
 
 static void game_render_shape_preview(Context* context, i32 left, i32 top) {
-    draw_quad_filled(context->Renderer, COLOR_ACCENT, {(f32)left - 16, (f32)top - 16, 160.0, 160.0});
-    draw_quad_filled(context->Renderer, COLOR_BACKGROUND, {(f32)left - 12, (f32)top - 12, 152.0, 152.0});
-    draw_quad_outline(context->Renderer, {0.0, 0.0, 0.0, 0.4}, {(f32)left - 16, (f32)top - 16, 160.0, 160.0});
-    draw_quad_outline(context->Renderer, {0.0, 0.0, 0.0, 0.4}, {(f32)left - 12, (f32)top - 12, 152.0, 152.0});
-    shape_render(context->Renderer, context->Game->NextShape, (f32)left, (f32)top);
+    draw_quad_filled(context->Renderer, PALETTE_ACCENT, {(f32)left - 16, (f32)top - 16, 160.0, 160.0});
+    draw_quad_filled(context->Renderer, PALETTE_BACKGROUND, {(f32)left - 12, (f32)top - 12, 152.0, 152.0});
+    draw_quad_outline(context->Renderer, PALETTE_OUTLINE, {(f32)left - 16, (f32)top - 16, 160.0, 160.0});
+    draw_quad_outline(context->Renderer, PALETTE_OUTLINE, {(f32)left - 12, (f32)top - 12, 152.0, 152.0});
+    game_render_shape(context, context->Game->Sim.NextShape, left, top);
     draw_text_centered(
         context->Renderer, 
         context->Game->MainFontMedium,
         "next",
-        COLOR_TEXT_DARK,
+        PALETTE_TEXT_DARK,
         left + 64,
         top + 160 + 24
     );
 }
 
-static void game_clear_lines(Context* context) {
-    u32 lineCount = field_clear_lines(context->Game->Field);
-    context->Game->TimeToMoveDown *= pow(0.97, lineCount);
-    context->Game->Score += s_LineClearScores[lineCount];
-}
-
-static void game_reset_cursor(Context* context) {
-    context->Game->PlayerX = 3;
-    context->Game->PlayerY = 16;
-}
-
-static void game_next_shape(Context* context, u32 ID) {
-    game_reset_cursor(context);
-    context->Game->CurrentShape = context->Game->NextShape;
-    context->Game->NextShape = s_Shapes[ID];
-    context->Game->CanSwap = true;
-
-    if (field_check_collision(
-        context->Game->Field,
-        context->Game->CurrentShape,
-        context->Game->PlayerX,
-        context->Game->PlayerY
-    )) {
-        CX_INFO("Game over");
-        game_over(context);
-    }
-}
-
-static bool game_try_move(Context* context, i32 dx, i32 dy) {
-    if (!field_check_collision(
-        context->Game->Field, 
-        context->Game->CurrentShape, 
-        context->Game->PlayerX + dx, 
-        context->Game->PlayerY + dy
-        )
-    ) {
-        context->Game->PlayerX += dx;
-        context->Game->PlayerY += dy;
-        return true;
-    }
-
-    return false;
-}
-
 /*
     Transitions for each state
 */
 
 void game_over(Context* context) {
-    context->Game->GameState = GameState::GameOver;
+    context->Game->Sim.GameState = GameState::GameOver;
+
+#if !CORTEX_PLATFORM_WEB
+    context->Game->Recording.Score = context->Game->Sim.Score;
+    replay_save(&context->Game->Recording, "last_replay.ttr");
+#endif
 }
 
 void game_restart(Context* context) {
     CX_INFO("Restarting!");
-    field_clear(context->Game->Field);
-
-    context->Game->CanSwap = true;
-    context->Game->GameState = GameState::Playing;
-
-    context->Game->Score = 0;
-
-    context->Game->ElapsedGameTime = 0.0;
-    context->Game->ElapsedSinceLastMoveDown = 0.0;
-    context->Game->ElapsedSinceLastSlide = 0.0;
-    context->Game->TimeToMoveDown = INIT_DROP_TIME;
-
-    context->Game->NextShape = s_Shapes[RandU32(1, 7)];
-    game_next_shape(context, RandU32(1, 7));
+    replay_reset(&context->Game->Recording);
+    game_sim_restart(context->Game->Sim, RandU32());
 }
 
 /*
@@ -285,146 +191,139 @@ static void gamestate_start_update(Context* context) {
     }
 }
 
-static void gamestate_playing_update(Context* context, f64 dt) {
-
-    context->Game->ElapsedGameTime += dt;
-    context->Game->ElapsedSinceLastMoveDown += dt;
-    context->Game->ElapsedSinceLastSlide += dt;
+static u32 s_InputKeyBits[INPUT_KEY_COUNT] = {
+    GAME_INPUT_UP,
+    GAME_INPUT_RIGHT,
+    GAME_INPUT_DOWN,
+    GAME_INPUT_LEFT,
+    GAME_INPUT_SPACE,
+    0, // Back pauses, it is not a game input.
+    GAME_INPUT_SWAP,
+};
 
-    // Update Audio
-    f32 fillFactor = field_fill_factor(context->Game->Field);
-    context->AudioEngine.setVolume(context->Game->BGMHandle, Lerp(MIN_BGM_VOLUME, MAX_BGM_VOLUME, fillFactor));
+// Tracks which keys are down, returns the event's GAME_INPUT_* bit.
+static u32 game_track_key(Context* context, const InputEvent& event) {
+    u32 bit = s_InputKeyBits[event.Key];
+    context->Game->InputDown = event.IsDown ? context->Game->InputDown | bit : context->Game->InputDown & ~bit;
+    return bit;
+}
 
-    // Handle piece swap
+/*
+    Builds the input for the tick ending at tickEnd from the queued events before it. A key that
+    goes down during the tick counts as pressed even if it is already back up by the end, and
+    only keys down for the whole tick count as held.
+*/
 
-    if (input_key_was_pressed_this_frame(context->Inputs->Swap) && context->Game->CanSwap) {
-        shape_swap(context->Game->CurrentShape, context->Game->NextShape);
-        game_reset_cursor(context);
-        context->Game->CanSwap = false;
+static GameInput game_collect_tick_input(Context* context, u32 tickEnd) {
+    GameInput input = {};
+    u32 startDown = context->Game->InputDown;
+    u32 changed = 0;
+
+    InputEvent event;
+    while (input_queue_pop(*context->InputEvents, tickEnd, &event)) {
+        bool wasDown = context->Game->InputDown & s_InputKeyBits[event.Key];
+        u32 bit = game_track_key(context, event);
+        input.Pressed |= event.IsDown && !wasDown ? bit : 0;
+        changed |= bit;
     }
 
-    // Handle rotation
+    input.Held = startDown & context->Game->InputDown & ~changed;
+    return input;
+}
 
-    if (input_key_was_pressed_this_frame(context->Inputs->Up)) {
-        Shape shape = context->Game->CurrentShape;
-        shape_rotate(shape);
-        if (!field_check_collision(context->Game->Field, shape, context->Game->PlayerX, context->Game->PlayerY)) {
-            shape_rotate(context->Game->CurrentShape);
-        }
+/*
+    Outside of play, events are consumed as they come so nothing pressed in a menu (the space
+    that starts a game, say) is replayed once play begins, and the tick clock restarts from now.
+*/
+
+static void game_sync_input(Context* context) {
+    u32 now = platform_get_time_ms();
+    InputEvent event;
+    while (input_queue_pop(*context->InputEvents, now + 1, &event)) {
+        game_track_key(context, event);
     }
+    context->Game->NextTickTime = (f64)now + 1000.0 * GAME_TICK_TIME;
+}
 
-    // Handle horizontal movement
+/*
+    Sound effects, synthesised with sfxr on the audio thread at startup rather than loaded from
+    files. Presets and seeds were picked by ear; line clears climb in pitch with the count.
+*/
 
-    if (input_key_was_pressed_this_frame(context->Inputs->Right)) {
-        game_try_move(context, 1, 0);
-        context->Game->ElapsedSinceLastSlide = 0.0;
-    }
+static const AudioSynth s_SoundSynths[GAME_SOUND_COUNT] = {
+    { AUDIO_SYNTH_HURT,      0x5d1c, -0.25f, 1.0f }, // GAME_SOUND_DROP
+    { AUDIO_SYNTH_BLIP,      0x0b17,  0.10f, 1.5f }, // GAME_SOUND_ROTATE
+    { AUDIO_SYNTH_COIN,      0x2a4f, -0.10f, 1.0f }, // GAME_SOUND_CLEAR_1
+    { AUDIO_SYNTH_COIN,      0x2a4f,  0.00f, 1.1f }, // GAME_SOUND_CLEAR_2
+    { AUDIO_SYNTH_COIN,      0x2a4f,  0.10f, 1.2f }, // GAME_SOUND_CLEAR_3
+    { AUDIO_SYNTH_POWERUP,   0x7e31,  0.10f, 1.5f }, // GAME_SOUND_CLEAR_4
+    { AUDIO_SYNTH_EXPLOSION, 0x4ac3, -0.10f, 1.0f }, // GAME_SOUND_GAME_OVER
+};
 
-    if (input_key_was_held_this_frame(context->Inputs->Right)) {
-        if (context->Game->ElapsedSinceLastSlide > QUICK_SLIDE_TIME) {
-            game_try_move(context, 1, 0);
-            context->Game->ElapsedSinceLastSlide = 0.0;
-        }
-    }
+static void game_play_sound(Context* context, GameSound sound) {
+    audio_play(context->Audio, context->Game->Sounds[sound], AUDIO_CHANNEL_NONE, 1.0f);
+}
 
-    if (input_key_was_pressed_this_frame(context->Inputs->Left)) {
-        game_try_move(context, -1, 0);
-        context->Game->ElapsedSinceLastSlide = 0.0;
+static void game_play_step_sounds(Context* context, const GameStepResult& result) {
+    if (result.Events & GAME_EVENT_ROTATED) {
+        game_play_sound(context, GAME_SOUND_ROTATE);
     }
 
-    if (input_key_was_held_this_frame(context->Inputs->Left)) {
-        if (context->Game->ElapsedSinceLastSlide > QUICK_SLIDE_TIME) {
-            game_try_move(context, -1, 0);
-            context->Game->ElapsedSinceLastSlide = 0.0;
-        }
+    if (result.Events & GAME_EVENT_KICK) {
+        game_play_sound(context, GAME_SOUND_DROP);
     }
 
-    // Handle downwards movement
-
-    if (input_key_was_held_this_frame(context->Inputs->Down)) {
-        if (context->Game->ElapsedSinceLastMoveDown > QUICK_DROP_TIME) {
-            if (!game_try_move(context, 0, -1)) {
-                field_place_shape(
-                    context->Game->Field, 
-                    context->Game->CurrentShape,
-                    context->Game->PlayerX,
-                    context->Game->PlayerY
-                );
-                game_next_shape(context, RandU32(1, 7));
-            }
-            context->Game->ElapsedSinceLastMoveDown = 0.0;
-        }
+    if (result.LinesCleared > 0) {
+        u32 lines = result.LinesCleared < 4 ? result.LinesCleared : 4;
+        game_play_sound(context, (GameSound)(GAME_SOUND_CLEAR_1 + lines - 1));
     }
 
-    if (input_key_was_pressed_this_frame(context->Inputs->Down)) {
-        if (!game_try_move(context, 0, -1)) {
-            field_place_shape(
-                context->Game->Field, 
-                context->Game->CurrentShape,
-                context->Game->PlayerX,
-                context->Game->PlayerY
-            );
-            game_next_shape(context, RandU32(1, 7));
-        }
-        context->Game->ElapsedSinceLastMoveDown = 0.0;
+    if (result.Events & GAME_EVENT_TOPPED_OUT) {
+        game_play_sound(context, GAME_SOUND_GAME_OVER);
     }
+}
 
-    // Handle quick-drop
+static void gamestate_playing_update(Context* context) {
 
-    if (input_key_was_pressed_this_frame(context->Inputs->Space)) {
-        i32 dy = 1;
-        while(!field_check_collision(
-            context->Game->Field, 
-            context->Game->CurrentShape, 
-            context->Game->PlayerX, 
-            context->Game->PlayerY - dy
-        )) {
-            dy ++;
-        }
-        
-        field_place_shape(
-            context->Game->Field, 
-            context->Game->CurrentShape,
-            context->Game->PlayerX,
-            context->Game->PlayerY - (dy - 1)
-        );
-        
-        context->AudioEngine.play(context->Game->KickSFX);
-        game_next_shape(context, RandU32(1, 7));
-
-        context->Game->ElapsedSinceLastMoveDown = 0.0;
-    }
+    // Update Audio
+    f32 fillFactor = field_fill_factor(context->Game->Sim.Field);
+    audio_set_volume(context->Audio, AUDIO_CHANNEL_BGM, Lerp(MIN_BGM_VOLUME, MAX_BGM_VOLUME, fillFactor));
 
     // Handle pause
 
     if (input_key_was_pressed_this_frame(context->Inputs->Back)) {
-        context->Game->GameState = GameState::Paused;
+        context->Game->Sim.GameState = GameState::Paused;
         return;
     }
 
-    // Rest of turn logic
+    // Run every tick that has ended by now, each on the events that fell inside it. The rules
+    // themselves live in game_sim.cpp.
 
-    if (context->Game->ElapsedSinceLastMoveDown > context->Game->TimeToMoveDown) {
-        if (!game_try_move(context, 0, -1)) {
-            field_place_shape(
-                context->Game->Field, 
-                context->Game->CurrentShape,
-                context->Game->PlayerX,
-                context->Game->PlayerY
-            );
-            context->AudioEngine.play(context->Game->KickSFX);
-            game_next_shape(context, RandU32(1, 7));
-        }
-
-        context->Game->ElapsedSinceLastMoveDown = 0.0;
+    const f64 tickLength = 1000.0 * GAME_TICK_TIME;
+    f64 now = (f64)platform_get_time_ms();
+    if (now - context->Game->NextTickTime > MAX_CATCHUP_TICKS * tickLength) {
+        context->Game->NextTickTime = now - MAX_CATCHUP_TICKS * tickLength;
     }
 
-    game_clear_lines(context);
+    while (context->Game->NextTickTime <= now && context->Game->Sim.GameState == GameState::Playing) {
+        GameInput input = game_collect_tick_input(context, (u32)context->Game->NextTickTime);
+        context->Game->NextTickTime += tickLength;
+
+        GameStepResult result;
+        game_sim_step(context->Game->Sim, input, &context->Game->Recording, &result);
+
+        game_play_step_sounds(context, result);
+
+        if (result.Events & GAME_EVENT_TOPPED_OUT) {
+            CX_INFO("Game over");
+            game_over(context);
+        }
+    }
 }
 
 static void gamestate_paused_update(Context* context) {
     if (input_key_was_pressed_this_frame(context->Inputs->Back)) {
-        context->Game->GameState = GameState::Playing;
+        context->Game->Sim.GameState = GameState::Playing;
     }
 }
 
@@ -434,45 +333,193 @@ static void gamestate_gameover_update(Context* context) {
     }
 }
 
+/*
+    Snapshots. GameSim is plain data, so both directions are a single copy.
+*/
+
+void game_snapshot(const Game* game, GameSnapshot* snapshot) {
+    memcpy(&snapshot->Sim, &game->Sim, sizeof(GameSim));
+}
+
+void game_restore(Game* game, const GameSnapshot* snapshot) {
+    memcpy(&game->Sim, &snapshot->Sim, sizeof(GameSim));
+}
+
 /*
     Main Game procedures.
 */
 
-void game_init(Context* context) {
-    context->Game->MainFontLarge = TTF_OpenFont("pico/pico-8.ttf", FONT_SIZE_LARGE);
-    CX_ASSERT(context->Game->MainFontLarge != NULL, "Failed to load font!");
+static AudioSound game_load_sound(Context* context, const char* name, bool isStream, bool isLooping) {
+    const u8* data;
+    u32 size;
+    if (platform_find_asset(context, name, &data, &size)) {
+        return audio_load_sound_memory(context->Audio, name, data, size, isStream, isLooping);
+    }
+    return audio_load_sound(context->Audio, name, isStream, isLooping);
+}
 
-    context->Game->MainFontMedium = TTF_OpenFont("pico/pico-8.ttf", FONT_SIZE_MEDIUM);
-    CX_ASSERT(context->Game->MainFontMedium != NULL, "Failed to load font!");
+/*
+    Asset loading. Everything the first frame needs is left out, so the window comes up at once
+    on GameState::Loading and the font (and the archive it comes from) loads behind it. On
+    desktop that is a thread of its own; the web fetches the archive asynchronously and bakes the
+    font when it arrives. The loading screen draws no text, and the atlas only becomes a texture
+    once loading is done, on the game thread. Sound effects need no assets and are queued
+    straight away.
+
+    Without the font the game cannot show anything but the loading screen, so a failure leaves
+    it there with the bar drawn in PALETTE_ERROR. The web has no loose files to fall back on.
+*/
+
+static void game_bake_font(Context* context) {
+    if (!platform_bake_font(context, "pico/pico-8.ttf", FONT_NATIVE_SIZE, &context->Game->PicoFont)) {
+        CX_ERROR("Failed to bake pico/pico-8.ttf.");
+        context->Game->HasLoadFailed = true;
+    }
+    context->Game->LoadSteps++;
+}
 
-    context->Game->MainFontSmall = TTF_OpenFont("pico/pico-8.ttf", FONT_SIZE_SMALL);
-    CX_ASSERT(context->Game->MainFontSmall != NULL, "Failed to load font!");
+static void game_log_archive(Context* context, bool isOpen) {
+    if (isOpen) {
+        CX_INFO("Assets %016llx.", (unsigned long long)context->Assets.Header->ContentHash);
+    } else {
+        CX_WARN("No asset archive, loading loose files.");
+    }
+}
 
-    context->Game->BGM.load("audio/bgm_trimmed.ogg");
-    context->Game->BGM.setLooping(1);
-    context->Game->BGM.setVolume(MIN_BGM_VOLUME);
-    context->Game->BGMHandle = context->AudioEngine.play(context->Game->BGM);
+#if CORTEX_PLATFORM_WEB
+static void game_on_archive_fetched(void* userData, void* buffer, i32 size) {
+    Context* context = (Context*)userData;
 
-    context->Game->KickSFX.load("audio/click2.wav");
-    context->Game->KickSFX.setLooping(0);
+    // The fetched buffer is freed when this returns, so the archive gets a copy of its own.
+    u8* data = new u8[size];
+    memcpy(data, buffer, (size_t)size);
+    game_log_archive(context, archive_open_memory(&context->Assets, data, (u64)size));
+    context->Game->LoadSteps++;
 
-    context->Game->GameState = GameState::Start;
+    game_bake_font(context);
+    context->Game->IsLoaded.store(true, std::memory_order_release);
+}
+
+static void game_on_archive_failed(void* userData) {
+    Context* context = (Context*)userData;
+    CX_ERROR("Failed to fetch %s.", ARCHIVE_PATH);
+    context->Game->HasLoadFailed = true;
+    context->Game->IsLoaded.store(true, std::memory_order_release);
+}
+#else
+static i32 game_load_assets(void* userData) {
+    Context* context = (Context*)userData;
+    game_log_archive(context, archive_open(&context->Assets, ARCHIVE_PATH));
+    context->Game->LoadSteps++;
+
+    game_bake_font(context);
+    context->Game->IsLoaded.store(true, std::memory_order_release);
+    return 0;
+}
+#endif
+
+static void gamestate_loading_update(Context* context) {
+    if (!context->Game->IsLoaded.load(std::memory_order_acquire)) {
+        return;
+    }
+
+#if !CORTEX_PLATFORM_WEB
+    if (context->Game->Loader) {
+        SDL_WaitThread(context->Game->Loader, NULL);
+        context->Game->Loader = NULL;
+    }
+#endif
+
+    if (context->Game->HasLoadFailed) {
+        return;
+    }
+
+    CX_ASSERT(context->Game->PicoFont.Pixels != NULL, "Failed to load font!");
+    platform_upload_font(context->Renderer, &context->Game->PicoFont);
+    CX_ASSERT(context->Game->PicoFont.Atlas != NULL, "Failed to create the font atlas!");
+
+    context->Game->BGM = game_load_sound(context, "audio/bgm_trimmed.ogg", true, true);
+    audio_play(context->Audio, context->Game->BGM, AUDIO_CHANNEL_BGM, MIN_BGM_VOLUME);
+
+    context->Game->Sim.GameState = GameState::Start;
+}
+
+static void game_render_loading(Context* context) {
+    game_render_background(context);
+
+    f32 progress = (f32)context->Game->LoadSteps.load(std::memory_order_relaxed) / LOAD_STEP_COUNT;
+    f32 width = context->WindowWidth / 2.0f;
+    Rect2D bar = { (context->WindowWidth - width) / 2.0f, context->WindowHeight / 2.0f - 8.0f, width, 16.0f };
+    draw_quad_outline(context->Renderer, PALETTE_TEXT_DARK, bar);
+
+    if (context->Game->HasLoadFailed) {
+        draw_quad_filled(context->Renderer, PALETTE_ERROR, bar);
+        return;
+    }
+
+    bar.w *= progress;
+    draw_quad_filled(context->Renderer, PALETTE_ACCENT, bar);
+}
+
+void game_init(Context* context) {
+    context->Game->Sim.GameState = GameState::Loading;
+    context->Game->LoadSteps = 0;
+    context->Game->IsLoaded = false;
+    context->Game->HasLoadFailed = false;
+
+    context->Game->MainFontLarge = { &context->Game->PicoFont, FONT_SCALE_LARGE };
+    context->Game->MainFontMedium = { &context->Game->PicoFont, FONT_SCALE_MEDIUM };
+    context->Game->MainFontSmall = { &context->Game->PicoFont, FONT_SCALE_SMALL };
+    context->Game->ScoreText.Value = HUD_VALUE_NONE;
+    context->Game->TimerText.Value = HUD_VALUE_NONE;
+
+    // The skin is generated rather than loaded, so it is ready before the first frame.
+    block_batch_init(&context->Game->Blocks);
+    bool hasSkin = block_skin_create(context->Renderer, &context->Game->Skin);
+    CX_ASSERT(hasSkin, "Failed to create the block skin!");
+
+#if CORTEX_PLATFORM_WEB
+    emscripten_async_wget_data(ARCHIVE_PATH, context, game_on_archive_fetched, game_on_archive_failed);
+#else
+    context->Game->Loader = SDL_CreateThread(game_load_assets, "Loader", context);
+    CX_ASSERT(context->Game->Loader != NULL, "Failed to start the asset loader.");
+#endif
+
+    for (u32 i = 0; i < GAME_SOUND_COUNT; i++) {
+        context->Game->Sounds[i] = audio_synth_sound(context->Audio, s_SoundSynths[i]);
+    }
+
+    if (!game_handling_load(context->Game->Sim.Handling, GAME_HANDLING_CONFIG_PATH)) {
+        CX_INFO("Using the default handling.");
+    }
 }
 
 void game_shutdown(Context* context) {
     // TODO: Clean up resources here.
+#if !CORTEX_PLATFORM_WEB
+    if (context->Game->Loader) {
+        SDL_WaitThread(context->Game->Loader, NULL);
+    }
+#endif
+    platform_free_font(&context->Game->PicoFont);
+    block_skin_destroy(&context->Game->Skin);
+    replay_free(&context->Game->Recording);
 }
 
 void game_update_and_render(Context* context, f64 dt) {
 
     // Run the base update for current state.
 
-    switch (context->Game->GameState) {
+    GameState state = context->Game->Sim.GameState;
+    switch (context->Game->Sim.GameState) {
+        case GameState::Loading:
+            gamestate_loading_update(context);
+            break;
         case GameState::Start:
             gamestate_start_update(context);
             break;
         case GameState::Playing:
-            gamestate_playing_update(context, dt);
+            gamestate_playing_update(context);
             break;
         case GameState::Paused:
             gamestate_paused_update(context);
@@ -482,11 +529,21 @@ void game_update_and_render(Context* context, f64 dt) {
             break;
     }
 
+    if (state != GameState::Playing) {
+        game_sync_input(context);
+    }
+
     // Rendering
 
+    if (context->Game->Sim.GameState == GameState::Loading) {
+        game_render_loading(context);
+        return;
+    }
+
     game_render_background(context);
     game_render_field(context, 0, 0);
     game_render_shape_preview(context, 480, 160);
+    block_batch_draw(context->Renderer, &context->Game->Skin, &context->Game->Blocks);
 
     game_render_score(context, 448, 224 + 224);
     game_render_timer(context, 448, 224 + 256);
@@ -495,48 +552,48 @@ void game_update_and_render(Context* context, f64 dt) {
         context->Renderer,
         context->Game->MainFontLarge,
         "tetris!",
-        COLOR_TEXT_DARK,
+        PALETTE_TEXT_DARK,
         544, 48
     );
 
     game_render_decorations(context);
 
-    if (context->Game->GameState != GameState::Playing) {
+    if (context->Game->Sim.GameState != GameState::Playing) {
         draw_quad_filled(
             context->Renderer,
-            COLOR_OVERLAY,
+            PALETTE_OVERLAY,
             { 0, 0, (f32)context->WindowWidth, (f32)context->WindowHeight }
         );
     }
 
-    if (context->Game->GameState == GameState::Start) {
+    if (context->Game->Sim.GameState == GameState::Start) {
         draw_text_centered(
             context->Renderer,
             context->Game->MainFontLarge,
             "press space to begin",
-            COLOR_TEXT_LIGHT,
+            PALETTE_TEXT_LIGHT,
             context->WindowWidth / 2,
             context->WindowHeight / 2
         );
     }
 
-    if (context->Game->GameState == GameState::Paused) {
+    if (context->Game->Sim.GameState == GameState::Paused) {
         draw_text_centered(
             context->Renderer,
             context->Game->MainFontLarge,
             "paused",
-            COLOR_TEXT_LIGHT,
+            PALETTE_TEXT_LIGHT,
             context->WindowWidth / 2,
             context->WindowHeight / 2
         );
     }
 
-    if (context->Game->GameState == GameState::GameOver) {
+    if (context->Game->Sim.GameState == GameState::GameOver) {
         draw_text_centered(
             context->Renderer,
             context->Game->MainFontLarge,
             "game over",
-            COLOR_TEXT_LIGHT,
+            PALETTE_TEXT_LIGHT,
             context->WindowWidth / 2,
             (context->WindowHeight / 2) - 24
         );
@@ -545,7 +602,7 @@ void game_update_and_render(Context* context, f64 dt) {
             context->Renderer,
             context->Game->MainFontMedium,
             "press space to play again",
-            COLOR_TEXT_LIGHT,
+            PALETTE_TEXT_LIGHT,
             context->WindowWidth / 2,
             (context->WindowHeight / 2) + 24
         );
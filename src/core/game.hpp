@@ -1,81 +1,99 @@
 #pragma once
 
 #include "core/base.h"
+#include "core/platform.hpp"
 #include "core/field.hpp"
 #include "core/shape.hpp"
 #include "core/input.hpp"
+#include "core/replay.hpp"
+#include "core/game_sim.hpp"
+#include "core/blocks.hpp"
 
-#include "soloud_wav.h"
-#include "soloud_wavstream.h"
+#include <atomic>
 
-struct Context;
 
-#define FONT_SIZE_LARGE 36
-#define FONT_SIZE_MEDIUM 24
-#define FONT_SIZE_SMALL 16
+struct Context;
 
-#define COLOR_BACKGROUND {0.976, 0.90, 0.830, 1.0}
-#define COLOR_WALLS {0.676, 0.50, 0.430, 1.0}
-#define COLOR_OVERLAY {0.18, 0.1, 0.14, 0.8}
+// pico-8.ttf is drawn on a 6 pixel em, baked once at that size and scaled by whole pixels.
+#define FONT_NATIVE_SIZE 6
+#define FONT_SCALE_LARGE 6
+#define FONT_SCALE_MEDIUM 4
+#define FONT_SCALE_SMALL 3
 
-#define COLOR_TEXTBACKGROUND {0.8, 0.8, 0.8, 0.2}
-#define COLOR_TEXT_DARK {0.1, 0.1, 0.16, 1.0}
-#define COLOR_TEXT_LIGHT {0.9, 0.9, 0.84, 1.0}
+// After a hitch longer than this the game slows down rather than run a burst of ticks.
+#define MAX_CATCHUP_TICKS 8
 
-#define COLOR_ACCENT {0.676, 0.50, 0.430, 1.0}
+#define MIN_BGM_VOLUME 0.6
+#define MAX_BGM_VOLUME 1.0
 
-// Time it takes for the piece to move down one row when no inputs are pressed at the start of the game.
-#define INIT_DROP_TIME 0.8
+// The archive and the font, counted off by the loading screen's progress bar.
+#define LOAD_STEP_COUNT 2
+
+// Audio channels the game adjusts after starting them, see audio.hpp.
+#define AUDIO_CHANNEL_BGM 0
+
+// Sound effects, all synthesised at startup (see s_SoundSynths).
+enum GameSound {
+    GAME_SOUND_DROP,
+    GAME_SOUND_ROTATE,
+    GAME_SOUND_CLEAR_1,
+    GAME_SOUND_CLEAR_2,
+    GAME_SOUND_CLEAR_3,
+    GAME_SOUND_CLEAR_4,
+    GAME_SOUND_GAME_OVER,
+    GAME_SOUND_COUNT
+};
 
-// Time it takes for the piece to move down one row when down is held.
-#define QUICK_DROP_TIME 0.1
+/*
+    A HUD string built from the number it shows, rebuilt only when that number changes (the
+    timer once a second, the score on line clears) so frames just draw what is there.
+*/
 
-// Time it takes for the piece to slide to the side one col when left/right is held.
-#define QUICK_SLIDE_TIME 0.14
+#define HUD_TEXT_LENGTH 20
+#define HUD_VALUE_NONE 0xffffffff
 
-#define MIN_BGM_VOLUME 0.6
-#define MAX_BGM_VOLUME 1.0
+struct HudText {
+    u32 Value;
+    i32 Width;
+    char Text[HUD_TEXT_LENGTH];
+};
 
-enum class GameState {
-    Start,
-    Paused,
-    Playing,
-    GameOver
+struct GameSnapshot {
+    GameSim Sim;
 };
 
 struct Game {
-    TTF_Font* MainFontLarge;
-    TTF_Font* MainFontMedium;
-    TTF_Font* MainFontSmall;
-
-    SoLoud::handle BGMHandle;
-    SoLoud::WavStream BGM;
-    SoLoud::Wav KickSFX;
-
-    GameState GameState;
-    
-    u32 Field[FIELD_SIZE];
-    i32 PlayerX;
-    i32 PlayerY;
-    
-    Shape CurrentShape;
-    Shape NextShape;
-    bool CanSwap;
-
-    u32 Score;
-
-    /*
-        TODO: Implement soft-locking.
-    */
-
-    // bool IsSoftLocked;
-    // f64 LockTime = 0.0;
-    // f64 LockDelay = 0.5;
-
-    f64 ElapsedGameTime = 0.0;
-    f64 ElapsedSinceLastMoveDown = 0.0;
-    f64 ElapsedSinceLastSlide = 0.0;
-    f64 TimeToMoveDown = INIT_DROP_TIME;
+    BitmapFont PicoFont;
+    Font MainFontLarge;
+    Font MainFontMedium;
+    Font MainFontSmall;
+
+    // The field, its walls and both pieces, drawn as one batch per frame.
+    BlockSkin Skin;
+    BlockBatch Blocks;
+
+    AudioSound BGM;
+    AudioSound Sounds[GAME_SOUND_COUNT];
+
+    // Set by the loader as it goes, see game_load_assets. Nothing it loads is touched on the
+    // game thread until IsLoaded.
+    SDL_Thread* Loader;
+    std::atomic<u32> LoadSteps;
+    std::atomic<bool> IsLoaded;
+    bool HasLoadFailed; // The font could not be had, loading stops on a failure screen.
+
+    GameSim Sim;
+
+    // Fixed-tick input: platform time the next tick ends at, and which GAME_INPUT_* keys are
+    // down as of the events consumed so far.
+    f64 NextTickTime;
+    u32 InputDown;
+
+    HudText ScoreText;
+    HudText TimerText;
+
+    // Recorded as each piece locks, and written out on game over (see finesse.hpp).
+    Replay Recording = {};
 };
 
 void game_init(Context* context);
@@ -83,4 +101,7 @@ void game_shutdown(Context* context);
 void game_update_and_render(Context* context, f64 dt);
 
 void game_over(Context* context);
-void game_restart(Context* context);
\ No newline at end of file
+void game_restart(Context* context);
+
+void game_snapshot(const Game* game, GameSnapshot* snapshot);
+void game_restore(Game* game, const GameSnapshot* snapshot);
\ No newline at end of file
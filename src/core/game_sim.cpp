@@ -0,0 +1,383 @@
+#include "core/game_sim.hpp"
+
+#include "core/sim.hpp"
+
+#include <cmath>
+
+/*
+    The drop time starts at INIT_DROP_TIME and shrinks by 3% for every line cleared. It is only
+    turned into rows per tick here, when the line count changes, so ticks never touch floats.
+    Capped at the field height per tick, past which falling any faster means nothing.
+*/
+
+static void game_sim_update_gravity(GameSim& sim) {
+    f64 ticksPerRow = INIT_DROP_TIME * GAME_TICK_RATE * pow(0.97, sim.Lines);
+    f64 gravity = round(GRAVITY_ONE_ROW / ticksPerRow);
+    sim.Gravity = gravity < FIELD_HEIGHT * GRAVITY_ONE_ROW ? (u32)gravity : FIELD_HEIGHT * GRAVITY_ONE_ROW;
+}
+
+static void game_sim_clear_lines(GameSim& sim, GameStepResult* result) {
+    u32 lineCount = field_clear_lines(sim.Field, nullptr);
+    if (lineCount > 0) {
+        sim.Lines += lineCount;
+        game_sim_update_gravity(sim);
+    }
+    sim.Score += sim_line_clear_score(lineCount);
+    result->LinesCleared += lineCount;
+}
+
+static void game_sim_reset_cursor(GameSim& sim) {
+    sim.PlayerX = SIM_SPAWN_X;
+    sim.PlayerY = SIM_SPAWN_Y;
+
+    // Key counts are per piece from the moment it enters the field.
+    sim.PieceStartRotation = (u8)shape_get_rotation(sim.CurrentShape);
+    sim.PieceRotatePresses = 0;
+    sim.PieceMovePresses = 0;
+}
+
+static void game_sim_record_piece(const GameSim& sim, i32 y, Replay* replay) {
+    if (!replay) {
+        return;
+    }
+
+    ReplayPiece piece = {};
+    piece.ShapeID = (u8)sim.CurrentShape.ID;
+    piece.StartRotation = sim.PieceStartRotation;
+    piece.Rotation = (u8)shape_get_rotation(sim.CurrentShape);
+    piece.X = (i8)sim.PlayerX;
+    piece.Y = (i8)y;
+    piece.RotatePresses = sim.PieceRotatePresses;
+    piece.MovePresses = sim.PieceMovePresses;
+    replay_append(replay, piece);
+}
+
+static void game_sim_count_press(u8& count) {
+    count = count < 0xff ? count + 1 : count;
+}
+
+static void game_sim_next_shape(GameSim& sim, u32 ID) {
+    sim.CurrentShape = sim.NextShape;
+    game_sim_reset_cursor(sim);
+    sim.NextShape = shape_get(ID);
+    sim.CanSwap = true;
+    game_sim_check_top_out(sim);
+}
+
+static bool game_sim_try_move(GameSim& sim, i32 dx, i32 dy) {
+    if (!field_check_collision(sim.Field, sim.CurrentShape, sim.PlayerX + dx, sim.PlayerY + dy)) {
+        sim.PlayerX += dx;
+        sim.PlayerY += dy;
+        return true;
+    }
+
+    return false;
+}
+
+static i32 game_sim_drop_distance(const GameSim& sim) {
+    i32 dy = 0;
+    while (!field_check_collision(sim.Field, sim.CurrentShape, sim.PlayerX, sim.PlayerY - (dy + 1))) {
+        dy++;
+    }
+    return dy;
+}
+
+/*
+    Columns the current piece can slide in `dir` before it hits the stack or a wall, so an
+    instant auto-repeat is one move rather than a collision test per column. Each row of a
+    piece is solid between its ends, so only the leading cell of each row needs checking: the
+    gap to the first filled cell past it, with the wall as a filled column, is a ctz away in
+    the row's bitmask from field_to_rows.
+*/
+
+static i32 game_sim_slide_distance(const GameSim& sim, i32 dir) {
+    u16 rows[FIELD_HEIGHT];
+    field_to_rows(sim.Field, rows);
+
+    i32 distance = FIELD_WIDTH;
+    for (i32 j = 0; j < 4; j++) {
+        u32 piece = 0;
+        for (i32 i = 0; i < 4; i++) {
+            if (sim.CurrentShape.Data[(j * 4) + i]) {
+                piece |= 1u << (i + sim.PlayerX + 1);
+            }
+        }
+        if (!piece) {
+            continue;
+        }
+
+        // Bit 0 and bit FIELD_WIDTH + 1 on are the walls, column c is bit c + 1.
+        i32 row = (3 - j) + sim.PlayerY;
+        u32 walled = 1u | (~0u << (FIELD_WIDTH + 1));
+        if (row < FIELD_HEIGHT) {
+            walled |= (u32)rows[row] << 1;
+        }
+
+        i32 gap;
+        if (dir > 0) {
+            i32 lead = 31 - __builtin_clz(piece);
+            gap = __builtin_ctz(walled >> (lead + 1));
+        } else {
+            i32 lead = __builtin_ctz(piece);
+            gap = lead - 1 - (31 - __builtin_clz(walled & ((1u << lead) - 1)));
+        }
+        distance = gap < distance ? gap : distance;
+    }
+    return distance;
+}
+
+static void game_sim_shift(GameSim& sim) {
+    if (sim.Handling.ARR == 0) {
+        sim.PlayerX += sim.ShiftDirection * game_sim_slide_distance(sim, sim.ShiftDirection);
+    } else {
+        game_sim_try_move(sim, sim.ShiftDirection, 0);
+    }
+}
+
+static u32 game_sim_direction_bit(i32 dir) {
+    return dir > 0 ? GAME_INPUT_RIGHT : GAME_INPUT_LEFT;
+}
+
+static void game_sim_start_shift(GameSim& sim, i32 dir) {
+    sim.ShiftDirection = (i8)dir;
+    sim.DASTicks = 0;
+    sim.ARRTicks = 0;
+}
+
+/*
+    Places the current piece at row y and brings in the next one. Returns false once that
+    tops the game out, at which point the rest of the step's inputs are ignored.
+*/
+
+static bool game_sim_lock(GameSim& sim, i32 y, bool kick, Replay* replay, GameStepResult* result) {
+    game_sim_record_piece(sim, y, replay);
+    field_place_shape(sim.Field, sim.CurrentShape, sim.PlayerX, y);
+    game_sim_next_shape(sim, sim_random_shape_id(sim.Seed));
+
+    result->Events |= GAME_EVENT_LOCKED;
+    if (kick) {
+        result->Events |= GAME_EVENT_KICK;
+    }
+    result->PiecesLocked++;
+
+    if (sim.GameState == GameState::GameOver) {
+        result->Events |= GAME_EVENT_TOPPED_OUT;
+        return false;
+    }
+    return true;
+}
+
+void game_sim_restart(GameSim& sim, u32 seed) {
+    field_clear(sim.Field);
+
+    sim.CanSwap = true;
+    sim.GameState = GameState::Playing;
+
+    sim.Score = 0;
+
+    sim.Lines = 0;
+    sim.Ticks = 0;
+    sim.DropProgress = 0;
+    game_sim_update_gravity(sim);
+
+    sim.ShiftDirection = 0;
+    sim.DASTicks = 0;
+    sim.ARRTicks = 0;
+
+    // Each game gets its own piece sequence, carried in the sim state so snapshots replay it exactly.
+    sim.Seed = seed;
+    sim.NextShape = shape_get(sim_random_shape_id(sim.Seed));
+    game_sim_next_shape(sim, sim_random_shape_id(sim.Seed));
+}
+
+/*
+    Ends the game if the current piece overlaps the stack, as happens when a piece spawns into
+    it or garbage pushes the stack up into the piece. Returns true if it did.
+*/
+
+bool game_sim_check_top_out(GameSim& sim) {
+    if (field_check_collision(sim.Field, sim.CurrentShape, sim.PlayerX, sim.PlayerY)) {
+        sim.GameState = GameState::GameOver;
+        return true;
+    }
+    return false;
+}
+
+static bool game_sim_handle_inputs(GameSim& sim, const GameInput& input, Replay* replay, GameStepResult* result) {
+
+    // Handle piece swap
+
+    if ((input.Pressed & GAME_INPUT_SWAP) && sim.CanSwap) {
+        shape_swap(sim.CurrentShape, sim.NextShape);
+        game_sim_reset_cursor(sim);
+        sim.CanSwap = false;
+    }
+
+    // Handle rotation
+
+    if (input.Pressed & GAME_INPUT_UP) {
+        game_sim_count_press(sim.PieceRotatePresses);
+        Shape shape = sim.CurrentShape;
+        shape_rotate(shape);
+        if (!field_check_collision(sim.Field, shape, sim.PlayerX, sim.PlayerY)) {
+            shape_rotate(sim.CurrentShape);
+            result->Events |= GAME_EVENT_ROTATED;
+        }
+    }
+
+    // Handle horizontal movement
+
+    if (input.Pressed & GAME_INPUT_RIGHT) {
+        game_sim_count_press(sim.PieceMovePresses);
+        game_sim_try_move(sim, 1, 0);
+        game_sim_start_shift(sim, 1);
+    }
+
+    if (input.Pressed & GAME_INPUT_LEFT) {
+        game_sim_count_press(sim.PieceMovePresses);
+        game_sim_try_move(sim, -1, 0);
+        game_sim_start_shift(sim, -1);
+    }
+
+    // Letting go of the direction being repeated hands over to the other one if it is still held.
+    if (sim.ShiftDirection != 0 && !((input.Pressed | input.Held) & game_sim_direction_bit(sim.ShiftDirection))) {
+        if (input.Held & game_sim_direction_bit(-sim.ShiftDirection)) {
+            game_sim_start_shift(sim, -sim.ShiftDirection);
+        } else {
+            sim.ShiftDirection = 0;
+        }
+    }
+
+    if (sim.ShiftDirection != 0 && (input.Held & game_sim_direction_bit(sim.ShiftDirection))) {
+        if (sim.DASTicks < sim.Handling.DAS) {
+            sim.DASTicks++;
+            if (sim.DASTicks == sim.Handling.DAS) {
+                game_sim_shift(sim);
+            }
+        } else if (++sim.ARRTicks >= sim.Handling.ARR) {
+            game_sim_shift(sim);
+            sim.ARRTicks = 0;
+        }
+    }
+
+    // Handle downwards movement
+
+    if (input.Pressed & GAME_INPUT_DOWN) {
+        if (!game_sim_try_move(sim, 0, -1) && !game_sim_lock(sim, sim.PlayerY, false, replay, result)) {
+            return false;
+        }
+        sim.DropProgress = 0;
+    }
+
+    bool softDrop = input.Held & GAME_INPUT_DOWN;
+    u64 gravity = sim.Gravity;
+    if (softDrop) {
+        if (sim.Handling.SoftDropFactor == 0) {
+            sim.PlayerY -= game_sim_drop_distance(sim);
+            sim.DropProgress = 0;
+            gravity = 0;
+        } else {
+            gravity *= sim.Handling.SoftDropFactor;
+        }
+    }
+
+    // Handle quick-drop
+
+    if (input.Pressed & GAME_INPUT_SPACE) {
+        if (!game_sim_lock(sim, sim.PlayerY - game_sim_drop_distance(sim), true, replay, result)) {
+            return false;
+        }
+        sim.DropProgress = 0;
+        gravity = 0;
+    }
+
+    // Rest of turn logic
+
+    u64 progress = sim.DropProgress + gravity;
+    if (progress > FIELD_HEIGHT * GRAVITY_ONE_ROW) {
+        progress = FIELD_HEIGHT * GRAVITY_ONE_ROW;
+    }
+    sim.DropProgress = (u32)progress;
+
+    while (sim.DropProgress >= GRAVITY_ONE_ROW) {
+        sim.DropProgress -= GRAVITY_ONE_ROW;
+        if (!game_sim_try_move(sim, 0, -1)) {
+            // Only gravity gets the kick sound, a soft drop lands quietly as it always has.
+            sim.DropProgress = 0;
+            if (!game_sim_lock(sim, sim.PlayerY, !softDrop, replay, result)) {
+                return false;
+            }
+        }
+    }
+
+    return true;
+}
+
+/*
+    Advances a game in the Playing state by one tick of GAME_TICK_TIME. `replay` may be null
+    when nobody needs the pieces recorded.
+*/
+
+void game_sim_step(GameSim& sim, const GameInput& input, Replay* replay, GameStepResult* result) {
+    *result = {};
+    if (sim.GameState != GameState::Playing) {
+        return;
+    }
+
+    sim.Ticks++;
+
+    game_sim_handle_inputs(sim, input, replay, result);
+    game_sim_clear_lines(sim, result);
+}
+
+/*
+    Reads handling from a text file of "das", "arr" and "sdf" lines, each followed by a number
+    of ticks (or the factor, for sdf). Anything not in the file keeps its current value. On a
+    missing file or any line that does not parse, nothing changes and false is returned.
+*/
+
+bool game_handling_load(GameHandling& handling, const char* path) {
+    FILE* file = fopen(path, "r");
+    if (!file) {
+        return false;
+    }
+
+    GameHandling loaded = handling;
+
+    bool ok = true;
+    char line[256];
+    u32 lineNumber = 0;
+    while (ok && fgets(line, sizeof(line), file)) {
+        lineNumber++;
+        char* hash = strchr(line, '#');
+        if (hash) {
+            *hash = '\0';
+        }
+
+        char name[16];
+        i32 value;
+        i32 count = sscanf(line, "%15s %d", name, &value);
+        if (count <= 0) {
+            continue;
+        }
+        if (count != 2 || value < 0 || value > 0xff) {
+            CX_ERROR("%s:%u: expected a setting and a value from 0 to 255.", path, lineNumber);
+            ok = false;
+        } else if (strcmp(name, "das") == 0) {
+            loaded.DAS = (u8)value;
+        } else if (strcmp(name, "arr") == 0) {
+            loaded.ARR = (u8)value;
+        } else if (strcmp(name, "sdf") == 0) {
+            loaded.SoftDropFactor = (u8)value;
+        } else {
+            CX_ERROR("%s:%u: unknown setting %s.", path, lineNumber, name);
+            ok = false;
+        }
+    }
+    fclose(file);
+
+    if (ok) {
+        handling = loaded;
+    }
+    return ok;
+}
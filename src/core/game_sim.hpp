@@ -0,0 +1,132 @@
+#pragma once
+
+#include "core/base.h"
+#include "core/field.hpp"
+#include "core/shape.hpp"
+#include "core/replay.hpp"
+
+#include <type_traits>
+
+/*
+    The rules of gamestate_playing_update with no Context, SDL or audio attached: a GameSim is
+    advanced one fixed tick at a time by a set of inputs, and reports what happened so the game
+    can play sounds and record replays around it. Unlike sim.hpp this runs at input level, with
+    gravity and key repeat, so two of them can be stepped in lockstep (see versus.hpp).
+*/
+
+// The game steps at a fixed rate however fast frames come, see game_sim_step.
+#define GAME_TICK_RATE 60
+#define GAME_TICK_TIME (1.0 / GAME_TICK_RATE)
+
+// Time it takes for the piece to move down one row when no inputs are pressed at the start of the game.
+#define INIT_DROP_TIME 0.8
+
+// Gravity is kept in rows per tick as 16.16 fixed point, so falling is integer maths every tick.
+#define GRAVITY_ONE_ROW (1 << 16)
+
+/*
+    Handling, all in ticks. DAS is how long left/right must be held before the piece starts
+    sliding on its own, ARR the ticks between each column after that, where 0 moves it to the
+    wall at once. Holding down multiplies gravity by the soft drop factor, 0 drops to the floor
+    at once (without locking).
+*/
+
+#define DEFAULT_DAS 10
+#define DEFAULT_ARR 2
+#define DEFAULT_SOFT_DROP_FACTOR 8
+
+#define GAME_HANDLING_CONFIG_PATH "handling.cfg"
+
+struct GameHandling {
+    u8 DAS;
+    u8 ARR;
+    u8 SoftDropFactor;
+};
+
+enum class GameState {
+    Loading,
+    Start,
+    Paused,
+    Playing,
+    GameOver
+};
+
+// One bit per key, set in GameInput::Pressed on the step a key goes down and in Held after that.
+enum GameInputBits : u32 {
+    GAME_INPUT_UP    = 1 << 0,
+    GAME_INPUT_RIGHT = 1 << 1,
+    GAME_INPUT_DOWN  = 1 << 2,
+    GAME_INPUT_LEFT  = 1 << 3,
+    GAME_INPUT_SPACE = 1 << 4,
+    GAME_INPUT_SWAP  = 1 << 5,
+};
+
+struct GameInput {
+    u32 Pressed;
+    u32 Held;
+};
+
+enum GameEventBits : u32 {
+    GAME_EVENT_LOCKED     = 1 << 0, // At least one piece was placed.
+    GAME_EVENT_KICK       = 1 << 1, // A hard drop or gravity lock, which the game plays its kick sound for.
+    GAME_EVENT_TOPPED_OUT = 1 << 2, // A new piece spawned overlapping the stack, the game is over.
+    GAME_EVENT_ROTATED    = 1 << 3, // The current piece turned.
+};
+
+struct GameStepResult {
+    u32 Events;
+    u32 PiecesLocked;
+    u32 LinesCleared;
+};
+
+/*
+    Everything the game's update works from, kept apart from fonts and audio so it is plain
+    data: copying it is a complete snapshot of a game in progress (see game_snapshot).
+*/
+
+struct GameSim {
+    ::GameState GameState; // Qualified, as the member shares the enum's name.
+
+    u32 Field[FIELD_SIZE];
+    i32 PlayerX;
+    i32 PlayerY;
+
+    Shape CurrentShape;
+    Shape NextShape;
+    bool CanSwap;
+
+    u32 Score;
+    u32 Seed; // Piece sequence, see sim_random_shape_id.
+
+    u32 Lines;
+
+    /*
+        TODO: Implement soft-locking.
+    */
+
+    // bool IsSoftLocked;
+    // f64 LockTime = 0.0;
+    // f64 LockDelay = 0.5;
+
+    GameHandling Handling = { DEFAULT_DAS, DEFAULT_ARR, DEFAULT_SOFT_DROP_FACTOR };
+
+    u32 Ticks = 0;
+    u32 Gravity = 0;      // Rows per tick, see GRAVITY_ONE_ROW.
+    u32 DropProgress = 0; // Towards the next row down.
+
+    i8 ShiftDirection = 0; // Direction left/right auto-repeat is charging in, 0 for none.
+    u8 DASTicks = 0;
+    u8 ARRTicks = 0;
+
+    u8 PieceStartRotation = 0;
+    u8 PieceRotatePresses = 0;
+    u8 PieceMovePresses = 0;
+};
+
+STATIC_ASSERT(std::is_trivially_copyable<GameSim>::value, "GameSim must stay plain data to be snapshotted.");
+
+bool game_handling_load(GameHandling& handling, const char* path);
+
+void game_sim_restart(GameSim& sim, u32 seed);
+bool game_sim_check_top_out(GameSim& sim);
+void game_sim_step(GameSim& sim, const GameInput& input, Replay* replay, GameStepResult* result);
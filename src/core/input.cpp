@@ -8,6 +8,43 @@ void input_set_keystate(KeyState& keystate, bool isDown, bool isRepeat) {
     keystate.IsRepeat = isRepeat;
 }
 
+KeyState& input_get_keystate(PlayerInputs& inputs, u32 key) {
+    KeyState* keys[INPUT_KEY_COUNT] = {
+        &inputs.Up,
+        &inputs.Right,
+        &inputs.Down,
+        &inputs.Left,
+        &inputs.Space,
+        &inputs.Back,
+        &inputs.Swap,
+    };
+    return *keys[key];
+}
+
+// Returns false, dropping the event, if the queue is full.
+bool input_queue_push(InputQueue& queue, const InputEvent& event) {
+    if (queue.Tail - queue.Head == INPUT_QUEUE_CAPACITY) {
+        return false;
+    }
+    queue.Events[queue.Tail % INPUT_QUEUE_CAPACITY] = event;
+    queue.Tail++;
+    return true;
+}
+
+// Takes the oldest event if it happened before the given time.
+bool input_queue_pop(InputQueue& queue, u32 before, InputEvent* event) {
+    if (queue.Head == queue.Tail) {
+        return false;
+    }
+    const InputEvent& next = queue.Events[queue.Head % INPUT_QUEUE_CAPACITY];
+    if ((i32)(next.Timestamp - before) >= 0) {
+        return false;
+    }
+    *event = next;
+    queue.Head++;
+    return true;
+}
+
 bool input_key_was_pressed_this_frame(KeyState& KeyState) {
     return (KeyState.IsDown && (KeyState.TransitionCount > 0));
 }
@@ -18,7 +18,44 @@ struct PlayerInputs {
     KeyState Swap;
 };
 
+/*
+    Every key change, in the order it happened, stamped with the platform time in milliseconds
+    (SDL event timestamps). KeyState only says where a key ended up each frame, so a press and
+    release inside one frame vanish from it; the queue keeps them, and the fixed-tick update
+    applies each one on the tick it fell in.
+*/
+
+enum InputKey : u8 {
+    INPUT_KEY_UP,
+    INPUT_KEY_RIGHT,
+    INPUT_KEY_DOWN,
+    INPUT_KEY_LEFT,
+    INPUT_KEY_SPACE,
+    INPUT_KEY_BACK,
+    INPUT_KEY_SWAP,
+    INPUT_KEY_COUNT
+};
+
+struct InputEvent {
+    u32 Timestamp;
+    u8 Key;
+    bool IsDown;
+};
+
+// Power of two. Far more than a frame's worth, events are drained every frame.
+#define INPUT_QUEUE_CAPACITY 256
+
+struct InputQueue {
+    InputEvent Events[INPUT_QUEUE_CAPACITY];
+    u32 Head; // Next event to read.
+    u32 Tail; // Next slot to write.
+};
+
 void input_set_keystate(KeyState& keystate, bool isDown, bool isRepeat);
+KeyState& input_get_keystate(PlayerInputs& inputs, u32 key);
+
+bool input_queue_push(InputQueue& queue, const InputEvent& event);
+bool input_queue_pop(InputQueue& queue, u32 before, InputEvent* event);
 
 bool input_key_was_pressed_this_frame(KeyState& KeyState);
 bool input_key_was_held_this_frame(KeyState& KeyState);
\ No newline at end of file
@@ -0,0 +1,132 @@
+#include "core/jobs.hpp"
+
+#include <atomic>
+#include <condition_variable>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+struct JobPool {
+    std::vector<std::thread> Workers;
+    std::mutex Mutex;
+    std::condition_variable WorkReady;
+    std::condition_variable WorkDone;
+
+    JobFunction Function = nullptr;
+    void* UserData = nullptr;
+    u32 Count = 0;
+    std::atomic<u32> NextIndex;
+    u32 Generation = 0;
+    u32 BusyWorkers = 0;
+    bool IsShuttingDown = false;
+};
+
+static void jobs_run_items(JobPool* pool, u32 threadIndex) {
+    for (;;) {
+        u32 index = pool->NextIndex.fetch_add(1, std::memory_order_relaxed);
+        if (index >= pool->Count) {
+            break;
+        }
+        pool->Function(pool->UserData, index, threadIndex);
+    }
+}
+
+static void jobs_worker_main(JobPool* pool, u32 threadIndex) {
+    u32 seenGeneration = 0;
+    for (;;) {
+        {
+            std::unique_lock<std::mutex> lock(pool->Mutex);
+            pool->WorkReady.wait(lock, [&] {
+                return pool->IsShuttingDown || pool->Generation != seenGeneration;
+            });
+            if (pool->IsShuttingDown) {
+                return;
+            }
+            seenGeneration = pool->Generation;
+        }
+
+        jobs_run_items(pool, threadIndex);
+
+        {
+            std::lock_guard<std::mutex> lock(pool->Mutex);
+            pool->BusyWorkers--;
+        }
+        pool->WorkDone.notify_one();
+    }
+}
+
+/*
+    A thread count of zero means "one thread per hardware core".
+*/
+
+JobPool* jobs_create(u32 threadCount) {
+    JobPool* pool = new JobPool();
+    pool->NextIndex = 0;
+
+#if CORTEX_PLATFORM_WEB
+    threadCount = 1;
+#else
+    if (threadCount == 0) {
+        threadCount = std::thread::hardware_concurrency();
+    }
+#endif
+
+    if (threadCount == 0) {
+        threadCount = 1;
+    }
+
+    for (u32 i = 1; i < threadCount; i++) {
+        pool->Workers.emplace_back(jobs_worker_main, pool, i);
+    }
+    return pool;
+}
+
+void jobs_destroy(JobPool* pool) {
+    {
+        std::lock_guard<std::mutex> lock(pool->Mutex);
+        pool->IsShuttingDown = true;
+    }
+    pool->WorkReady.notify_all();
+    for (std::thread& worker : pool->Workers) {
+        worker.join();
+    }
+    delete pool;
+}
+
+u32 jobs_thread_count(JobPool* pool) {
+    return (u32)pool->Workers.size() + 1;
+}
+
+/*
+    Runs function(userData, i, threadIndex) for every i in [0, count) and returns once all of
+    them have finished. Items are handed out one at a time so uneven work balances itself.
+*/
+
+void jobs_parallel_for(JobPool* pool, u32 count, JobFunction function, void* userData) {
+    if (count == 0) {
+        return;
+    }
+
+    if (pool->Workers.empty() || count == 1) {
+        for (u32 i = 0; i < count; i++) {
+            function(userData, i, 0);
+        }
+        return;
+    }
+
+    {
+        std::lock_guard<std::mutex> lock(pool->Mutex);
+        pool->Function = function;
+        pool->UserData = userData;
+        pool->Count = count;
+        pool->NextIndex.store(0, std::memory_order_relaxed);
+        pool->BusyWorkers = (u32)pool->Workers.size();
+        pool->Generation++;
+    }
+    pool->WorkReady.notify_all();
+
+    jobs_run_items(pool, 0);
+
+    std::unique_lock<std::mutex> lock(pool->Mutex);
+    pool->WorkDone.wait(lock, [&] { return pool->BusyWorkers == 0; });
+}
@@ -0,0 +1,18 @@
+#pragma once
+
+#include "core/base.h"
+
+/*
+    A small fixed pool of worker threads for fanning independent work items out across cores.
+    The calling thread always takes part as thread index 0, so a pool created with a single
+    thread simply runs everything inline (which is also what happens on the web build).
+*/
+
+typedef void (*JobFunction)(void* userData, u32 index, u32 threadIndex);
+
+struct JobPool;
+
+JobPool* jobs_create(u32 threadCount);
+void jobs_destroy(JobPool* pool);
+u32 jobs_thread_count(JobPool* pool);
+void jobs_parallel_for(JobPool* pool, u32 count, JobFunction function, void* userData);
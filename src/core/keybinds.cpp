@@ -0,0 +1,136 @@
+#include "core/keybinds.hpp"
+
+static const char* s_ActionNames[INPUT_KEY_COUNT] = {
+    "rotate",
+    "right",
+    "soft_drop",
+    "left",
+    "hard_drop",
+    "pause",
+    "swap",
+};
+
+const char* keybinds_action_name(u32 key) {
+    return s_ActionNames[key];
+}
+
+static void keybinds_clear(KeyBindings& bindings) {
+    memset(bindings.Scancodes, KEYBIND_NONE, sizeof(bindings.Scancodes));
+    memset(bindings.Buttons, KEYBIND_NONE, sizeof(bindings.Buttons));
+    memset(bindings.DownCount, 0, sizeof(bindings.DownCount));
+}
+
+/*
+    WASD and the arrow keys as the game always had, plus a standard gamepad layout.
+*/
+
+void keybinds_set_defaults(KeyBindings& bindings) {
+    keybinds_clear(bindings);
+
+    bindings.Scancodes[SDL_SCANCODE_W] = INPUT_KEY_UP;
+    bindings.Scancodes[SDL_SCANCODE_UP] = INPUT_KEY_UP;
+    bindings.Scancodes[SDL_SCANCODE_D] = INPUT_KEY_RIGHT;
+    bindings.Scancodes[SDL_SCANCODE_RIGHT] = INPUT_KEY_RIGHT;
+    bindings.Scancodes[SDL_SCANCODE_S] = INPUT_KEY_DOWN;
+    bindings.Scancodes[SDL_SCANCODE_DOWN] = INPUT_KEY_DOWN;
+    bindings.Scancodes[SDL_SCANCODE_A] = INPUT_KEY_LEFT;
+    bindings.Scancodes[SDL_SCANCODE_LEFT] = INPUT_KEY_LEFT;
+    bindings.Scancodes[SDL_SCANCODE_SPACE] = INPUT_KEY_SPACE;
+    bindings.Scancodes[SDL_SCANCODE_ESCAPE] = INPUT_KEY_BACK;
+    bindings.Scancodes[SDL_SCANCODE_E] = INPUT_KEY_SWAP;
+
+    bindings.Buttons[SDL_CONTROLLER_BUTTON_B] = INPUT_KEY_UP;
+    bindings.Buttons[SDL_CONTROLLER_BUTTON_DPAD_UP] = INPUT_KEY_SPACE;
+    bindings.Buttons[SDL_CONTROLLER_BUTTON_DPAD_RIGHT] = INPUT_KEY_RIGHT;
+    bindings.Buttons[SDL_CONTROLLER_BUTTON_DPAD_DOWN] = INPUT_KEY_DOWN;
+    bindings.Buttons[SDL_CONTROLLER_BUTTON_DPAD_LEFT] = INPUT_KEY_LEFT;
+    bindings.Buttons[SDL_CONTROLLER_BUTTON_A] = INPUT_KEY_SPACE;
+    bindings.Buttons[SDL_CONTROLLER_BUTTON_START] = INPUT_KEY_BACK;
+    bindings.Buttons[SDL_CONTROLLER_BUTTON_LEFTSHOULDER] = INPUT_KEY_SWAP;
+    bindings.Buttons[SDL_CONTROLLER_BUTTON_RIGHTSHOULDER] = INPUT_KEY_SWAP;
+}
+
+/*
+    Replaces the bindings with the ones in the file. On a missing file or any line that does not
+    parse, the bindings are left as they were and false is returned.
+*/
+
+bool keybinds_load(KeyBindings& bindings, const char* path) {
+    FILE* file = fopen(path, "r");
+    if (!file) {
+        return false;
+    }
+
+    KeyBindings loaded;
+    keybinds_clear(loaded);
+
+    bool ok = true;
+    char line[256];
+    u32 lineNumber = 0;
+    while (ok && fgets(line, sizeof(line), file)) {
+        lineNumber++;
+        char* hash = strchr(line, '#');
+        if (hash) {
+            *hash = '\0';
+        }
+
+        char* token = strtok(line, " \t\r\n");
+        if (!token) {
+            continue;
+        }
+
+        u32 action = INPUT_KEY_COUNT;
+        for (u32 i = 0; i < INPUT_KEY_COUNT; i++) {
+            if (strcmp(token, s_ActionNames[i]) == 0) {
+                action = i;
+            }
+        }
+        if (action == INPUT_KEY_COUNT) {
+            CX_ERROR("%s:%u: unknown action %s.", path, lineNumber, token);
+            ok = false;
+            break;
+        }
+
+        while ((token = strtok(nullptr, " \t\r\n"))) {
+            if (strncmp(token, "pad:", 4) == 0) {
+                SDL_GameControllerButton button = SDL_GameControllerGetButtonFromString(token + 4);
+                if (button == SDL_CONTROLLER_BUTTON_INVALID) {
+                    CX_ERROR("%s:%u: unknown controller button %s.", path, lineNumber, token + 4);
+                    ok = false;
+                    break;
+                }
+                loaded.Buttons[button] = (u8)action;
+            } else {
+                SDL_Scancode scancode = SDL_GetScancodeFromName(token);
+                if (scancode == SDL_SCANCODE_UNKNOWN) {
+                    CX_ERROR("%s:%u: unknown key %s.", path, lineNumber, token);
+                    ok = false;
+                    break;
+                }
+                loaded.Scancodes[scancode] = (u8)action;
+            }
+        }
+    }
+    fclose(file);
+
+    if (ok) {
+        bindings = loaded;
+    }
+    return ok;
+}
+
+/*
+    Counts a bound key or button going down or up. Returns true when that changes whether the
+    action is down, which is the only time the game needs to hear about it.
+*/
+
+bool keybinds_press(KeyBindings& bindings, u32 key, bool isDown) {
+    u8& count = bindings.DownCount[key];
+    if (isDown) {
+        return count++ == 0;
+    }
+    if (count == 0) {
+        return false; // Released a key that went down before the bindings were loaded.
+    }
+    return --count == 0;
+}
@@ -0,0 +1,35 @@
+#pragma once
+
+#include "core/base.h"
+#include "core/input.hpp"
+#include "core/platform.hpp"
+
+/*
+    Key and gamepad bindings. Every SDL scancode and controller button maps straight to an
+    InputKey (or KEYBIND_NONE), so turning an event into an input is one array lookup. Any
+    number of keys and buttons can share an action; it stays down while any of them is.
+
+    Bindings load from a text file, one action per line followed by what triggers it: SDL
+    scancode names ("Left", "A", "Space") or "pad:" and an SDL controller button name:
+
+        # action   bindings...
+        left       A Left pad:dpleft
+        hard_drop  Space pad:a
+*/
+
+#define KEYBIND_NONE 0xff
+#define KEYBIND_CONFIG_PATH "keybinds.cfg"
+
+struct KeyBindings {
+    u8 Scancodes[SDL_NUM_SCANCODES];
+    u8 Buttons[SDL_CONTROLLER_BUTTON_MAX];
+
+    // How many bound keys and buttons are down for each action.
+    u8 DownCount[INPUT_KEY_COUNT];
+};
+
+void keybinds_set_defaults(KeyBindings& bindings);
+bool keybinds_load(KeyBindings& bindings, const char* path);
+const char* keybinds_action_name(u32 key);
+
+bool keybinds_press(KeyBindings& bindings, u32 key, bool isDown);
@@ -0,0 +1,262 @@
+#include "core/netplay.hpp"
+#include "core/utils.hpp"
+
+/*
+    Packets are a small header followed by two bytes (pressed, held) per input, starting at
+    FirstTick. Ack is the number of the peer's ticks whose inputs have arrived, in order.
+*/
+
+#define NETPLAY_PACKET_MAGIC 0x5054 // "TP"
+
+struct NetplayPacketHeader {
+    u16 Magic;
+    u16 Count;
+    u32 FirstTick;
+    u32 Ack;
+};
+
+STATIC_ASSERT(sizeof(NetplayPacketHeader) == 12, "Netplay packet header layout must not change.");
+STATIC_ASSERT(sizeof(NetplayPacketHeader) + 2 * NETPLAY_HISTORY <= NET_MAX_PACKET, "Netplay packets must fit the transport.");
+
+struct NetplaySession {
+    NetTransport Transport;
+    u32 Local;
+    u32 Remote;
+
+    // State at the start of CurrentTick.
+    VersusMatch Match;
+    u32 CurrentTick;
+
+    // Indexed by tick % NETPLAY_HISTORY. Snapshots are taken at the start of a tick, inputs are
+    // what that tick ran with: the remote one is a prediction until RemoteReceived passes it.
+    VersusMatch Snapshots[NETPLAY_HISTORY];
+    GameInput Inputs[NETPLAY_HISTORY][VERSUS_PLAYER_COUNT];
+
+    u32 RemoteReceived; // Remote inputs are known for every tick before this.
+    u32 RemoteAcked;    // The peer has our inputs for every tick before this.
+    u32 RollbackFrom;   // Earliest tick that ran on a wrong prediction, NETPLAY_NO_ROLLBACK if none.
+
+    NetplayStats Stats;
+};
+
+#define NETPLAY_NO_ROLLBACK UINT32_MAX
+
+NetplaySession* netplay_create(NetTransport transport, u32 localPlayer, u32 pieceSeed, u32 garbageSeed) {
+    CX_ASSERT(localPlayer < VERSUS_PLAYER_COUNT, "Invalid netplay player!");
+
+    NetplaySession* session = new NetplaySession();
+    session->Transport = transport;
+    session->Local = localPlayer;
+    session->Remote = (localPlayer + 1) % VERSUS_PLAYER_COUNT;
+    versus_reset(session->Match, pieceSeed, garbageSeed);
+    session->CurrentTick = 0;
+    session->RemoteReceived = 0;
+    session->RemoteAcked = 0;
+    session->RollbackFrom = NETPLAY_NO_ROLLBACK;
+    session->Stats = {};
+    return session;
+}
+
+void netplay_destroy(NetplaySession* session) {
+    delete session;
+}
+
+static u8 netplay_encode(u32 bits) {
+    return (u8)(bits & 0xff);
+}
+
+/*
+    Guess for a remote input that has not arrived: whatever was held or pressed at the last
+    known tick is still held, and nothing new goes down.
+*/
+
+static GameInput netplay_predict(const NetplaySession* session) {
+    GameInput prediction = {};
+    if (session->RemoteReceived > 0) {
+        const GameInput& last = session->Inputs[(session->RemoteReceived - 1) % NETPLAY_HISTORY][session->Remote];
+        prediction.Held = last.Held | last.Pressed;
+    }
+    return prediction;
+}
+
+static GameInput& netplay_remote_input(NetplaySession* session, u32 tick) {
+    GameInput& input = session->Inputs[tick % NETPLAY_HISTORY][session->Remote];
+    if (tick >= session->RemoteReceived) {
+        input = netplay_predict(session);
+    }
+    return input;
+}
+
+static void netplay_send(NetplaySession* session) {
+    u8 packet[NET_MAX_PACKET];
+
+    // Everything the peer has not acknowledged, as far back as the history still holds.
+    u32 first = session->RemoteAcked;
+    if (session->CurrentTick > NETPLAY_HISTORY && first < session->CurrentTick - NETPLAY_HISTORY) {
+        first = session->CurrentTick - NETPLAY_HISTORY;
+    }
+
+    NetplayPacketHeader header;
+    header.Magic = NETPLAY_PACKET_MAGIC;
+    header.Count = (u16)(session->CurrentTick - first);
+    header.FirstTick = first;
+    header.Ack = session->RemoteReceived;
+    memcpy(packet, &header, sizeof(header));
+
+    u8* cursor = packet + sizeof(header);
+    for (u32 tick = first; tick < session->CurrentTick; tick++) {
+        const GameInput& input = session->Inputs[tick % NETPLAY_HISTORY][session->Local];
+        *cursor++ = netplay_encode(input.Pressed);
+        *cursor++ = netplay_encode(input.Held);
+    }
+
+    session->Transport.Send(session->Transport.User, packet, (u32)(cursor - packet));
+    session->Stats.PacketsSent++;
+}
+
+/*
+    Everything in a packet comes from the network, so it is checked before any of it is used and
+    the whole packet dropped if it does not fit: a well-behaved peer never sends more than the
+    history holds, nor runs so far ahead that its inputs would overwrite ticks still needed for
+    rollback. An Ack outside what has been sent only means a stale packet, and is ignored.
+*/
+
+static bool netplay_read_packet(NetplaySession* session, const u8* packet, u32 size) {
+    NetplayPacketHeader header;
+    if (size < sizeof(header)) {
+        return false;
+    }
+    memcpy(&header, packet, sizeof(header));
+    if (header.Magic != NETPLAY_PACKET_MAGIC || size < sizeof(header) + 2 * header.Count) {
+        return false;
+    }
+
+    u64 endTick = (u64)header.FirstTick + header.Count;
+    if (header.Count > NETPLAY_HISTORY || endTick > (u64)session->CurrentTick + NETPLAY_HISTORY - NETPLAY_MAX_ROLLBACK) {
+        return false;
+    }
+    session->Stats.PacketsReceived++;
+
+    if (header.Ack > session->RemoteAcked && header.Ack <= session->CurrentTick) {
+        session->RemoteAcked = header.Ack;
+    }
+
+    const u8* inputs = packet + sizeof(header);
+    for (u32 i = 0; i < header.Count; i++) {
+        u32 tick = header.FirstTick + i;
+
+        // Only take inputs in order. Anything past a gap comes again in the next packet.
+        if (tick != session->RemoteReceived) {
+            continue;
+        }
+
+        GameInput input;
+        input.Pressed = inputs[2 * i];
+        input.Held = inputs[2 * i + 1];
+
+        GameInput& slot = session->Inputs[tick % NETPLAY_HISTORY][session->Remote];
+        if (tick < session->CurrentTick && (slot.Pressed != input.Pressed || slot.Held != input.Held)) {
+            session->RollbackFrom = tick < session->RollbackFrom ? tick : session->RollbackFrom;
+        }
+        slot = input;
+        session->RemoteReceived++;
+    }
+    return true;
+}
+
+/*
+    Goes back to the earliest mispredicted tick and runs every tick since again, with the inputs
+    now known and fresh predictions for the rest.
+*/
+
+static void netplay_rollback(NetplaySession* session) {
+    u32 from = session->RollbackFrom;
+    session->RollbackFrom = NETPLAY_NO_ROLLBACK;
+    if (from == NETPLAY_NO_ROLLBACK) {
+        return;
+    }
+
+    Utils::Clock timer;
+    memcpy(&session->Match, &session->Snapshots[from % NETPLAY_HISTORY], sizeof(VersusMatch));
+    for (u32 tick = from; tick < session->CurrentTick; tick++) {
+        GameInput* inputs = session->Inputs[tick % NETPLAY_HISTORY];
+        netplay_remote_input(session, tick);
+        memcpy(&session->Snapshots[tick % NETPLAY_HISTORY], &session->Match, sizeof(VersusMatch));
+        versus_step(session->Match, inputs);
+    }
+    f64 seconds = timer.Tick();
+
+    u32 count = session->CurrentTick - from;
+    NetplayStats& stats = session->Stats;
+    stats.Rollbacks++;
+    stats.ResimulatedTicks += count;
+    stats.MaxRollback = count > stats.MaxRollback ? count : stats.MaxRollback;
+    stats.RollbackSeconds += seconds;
+    stats.MaxRollbackSeconds = seconds > stats.MaxRollbackSeconds ? seconds : stats.MaxRollbackSeconds;
+}
+
+static void netplay_receive(NetplaySession* session) {
+    u8 packet[NET_MAX_PACKET];
+    u32 size;
+    while ((size = session->Transport.Receive(session->Transport.User, packet, sizeof(packet))) > 0) {
+        if (!netplay_read_packet(session, packet, size)) {
+            session->Stats.PacketsRejected++;
+        }
+    }
+    netplay_rollback(session);
+}
+
+/*
+    Takes in whatever the peer has sent and rolls back if it has to, without moving on a tick.
+    Call this while waiting, e.g. at the end of a match, so the peer still gets acknowledgements.
+*/
+
+void netplay_poll(NetplaySession* session) {
+    netplay_receive(session);
+    netplay_send(session);
+}
+
+/*
+    Runs one tick with the local input. Returns false, without using the input, when the
+    session is as far ahead of the peer as rollback allows; try again with the same input.
+*/
+
+bool netplay_advance(NetplaySession* session, const GameInput& localInput) {
+    netplay_receive(session);
+
+    if (session->CurrentTick >= session->RemoteReceived + NETPLAY_MAX_ROLLBACK) {
+        session->Stats.Stalls++;
+        netplay_send(session);
+        return false;
+    }
+
+    u32 tick = session->CurrentTick;
+    GameInput* inputs = session->Inputs[tick % NETPLAY_HISTORY];
+    inputs[session->Local] = localInput;
+    netplay_remote_input(session, tick);
+
+    memcpy(&session->Snapshots[tick % NETPLAY_HISTORY], &session->Match, sizeof(VersusMatch));
+    versus_step(session->Match, inputs);
+    session->CurrentTick++;
+    session->Stats.Ticks++;
+
+    netplay_send(session);
+    return true;
+}
+
+const VersusMatch& netplay_get_match(const NetplaySession* session) {
+    return session->Match;
+}
+
+u32 netplay_current_tick(const NetplaySession* session) {
+    return session->CurrentTick;
+}
+
+// Ticks before this ran on real inputs from both sides and will never be rolled back.
+u32 netplay_confirmed_tick(const NetplaySession* session) {
+    return session->RemoteReceived < session->CurrentTick ? session->RemoteReceived : session->CurrentTick;
+}
+
+NetplayStats netplay_get_stats(const NetplaySession* session) {
+    return session->Stats;
+}
@@ -0,0 +1,51 @@
+#pragma once
+
+#include "core/base.h"
+#include "core/versus.hpp"
+#include "core/transport.hpp"
+
+/*
+    Rollback netplay for versus matches. Each tick runs straight away on the local input and a
+    prediction of the remote one (the keys it last held stay held, nothing new is pressed). When
+    the real remote input for an earlier tick arrives and differs from the guess, the match is
+    restored from the snapshot taken at that tick and every tick since is simulated again.
+
+    Every packet carries all the local inputs the peer has not acknowledged yet, so a lost
+    packet is covered by the next one and nothing is ever resent on a timer. A session that
+    gets NETPLAY_MAX_ROLLBACK ticks ahead of the last remote input it has stops advancing until
+    the peer catches up, which bounds the work of any one rollback.
+*/
+
+#define NETPLAY_MAX_ROLLBACK 10
+
+// Ticks of snapshots and inputs kept. Must cover the rollback window both ways, as the peer
+// may be up to NETPLAY_MAX_ROLLBACK ticks ahead.
+#define NETPLAY_HISTORY 32
+
+STATIC_ASSERT(NETPLAY_HISTORY > 2 * NETPLAY_MAX_ROLLBACK + 1, "Netplay history too short for the rollback window.");
+
+struct NetplayStats {
+    u64 Ticks;
+    u64 Stalls;             // advance calls that waited on the peer.
+    u64 Rollbacks;
+    u64 ResimulatedTicks;
+    u32 MaxRollback;        // Most ticks simulated again by one rollback.
+    f64 RollbackSeconds;
+    f64 MaxRollbackSeconds;
+    u64 PacketsSent;
+    u64 PacketsReceived;
+    u64 PacketsRejected;    // Malformed, or covering ticks the session cannot hold.
+};
+
+struct NetplaySession;
+
+NetplaySession* netplay_create(NetTransport transport, u32 localPlayer, u32 pieceSeed, u32 garbageSeed);
+void netplay_destroy(NetplaySession* session);
+
+bool netplay_advance(NetplaySession* session, const GameInput& localInput);
+void netplay_poll(NetplaySession* session);
+
+const VersusMatch& netplay_get_match(const NetplaySession* session);
+u32 netplay_current_tick(const NetplaySession* session);
+u32 netplay_confirmed_tick(const NetplaySession* session);
+NetplayStats netplay_get_stats(const NetplaySession* session);
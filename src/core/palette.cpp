@@ -0,0 +1,26 @@
+#include "core/palette.hpp"
+
+static const PaletteColor s_Palette[PALETTE_COUNT] = {
+    { 248, 229, 211, 255 }, // PALETTE_EMPTY, also the background.
+    {   0,  96, 146, 255 },
+    {   1, 194, 180, 255 },
+    { 244, 156,  46, 255 },
+    { 233,  86,  57, 255 },
+    { 201,  14,  88, 255 },
+    { 207,  39, 226, 255 },
+    {  75, 225, 105, 255 },
+    { 141, 130, 126, 255 }, // PALETTE_GARBAGE
+    { 172, 127, 109, 255 }, // PALETTE_WALLS
+    { 172, 127, 109, 255 }, // PALETTE_ACCENT
+    {   0,   0,   0, 102 }, // PALETTE_OUTLINE
+    { 255, 255, 255,  25 }, // PALETTE_CELL_SHADE
+    {  45,  25,  35, 204 }, // PALETTE_OVERLAY
+    {  25,  25,  40, 255 }, // PALETTE_TEXT_DARK
+    { 229, 229, 214, 255 }, // PALETTE_TEXT_LIGHT
+    { 201,  14,  88, 255 }, // PALETTE_ERROR
+};
+
+const PaletteColor& palette_get(u32 index) {
+    CX_DEBUGASSERT(index < PALETTE_COUNT, "Palette index out of range!");
+    return s_Palette[index];
+}
@@ -0,0 +1,34 @@
+#pragma once
+
+#include "core/base.h"
+#include "core/shape.hpp"
+
+/*
+    Every colour the game draws with, packed to RGBA8 once here rather than converted from
+    floats on each draw. The first entries are indexed by shape ID, so a field cell's value is
+    its colour as it stands; the fixed interface colours follow.
+*/
+
+struct PaletteColor {
+    u8 R;
+    u8 G;
+    u8 B;
+    u8 A;
+};
+
+enum PaletteIndex : u8 {
+    PALETTE_EMPTY = 0,                     // Shape ID 0, the background under empty cells.
+    PALETTE_GARBAGE = SHAPE_GARBAGE_ID,
+    PALETTE_BACKGROUND = PALETTE_EMPTY,
+    PALETTE_WALLS = SHAPE_GARBAGE_ID + 1,
+    PALETTE_ACCENT,
+    PALETTE_OUTLINE,
+    PALETTE_CELL_SHADE,
+    PALETTE_OVERLAY,
+    PALETTE_TEXT_DARK,
+    PALETTE_TEXT_LIGHT,
+    PALETTE_ERROR,
+    PALETTE_COUNT
+};
+
+const PaletteColor& palette_get(u32 index);
@@ -1,25 +1,23 @@
 #include "core/platform.hpp"
 #include "core/game.hpp"
+#include "core/keybinds.hpp"
 
 #include "maths/random.hpp"
 
-static SDL_Color color_from_vec4(Vec4 color) {
-    return {
-        (u8)(color.x * 255.0),
-        (u8)(color.y * 255.0),
-        (u8)(color.z * 255.0),
-        (u8)(color.w * 255.0)
-    };
+static void platform_set_draw_color(SDL_Renderer* renderer, u8 color) {
+    const PaletteColor& col = palette_get(color);
+    SDL_SetRenderDrawColor(renderer, col.R, col.G, col.B, col.A);
 }
 
 Context* platform_init() {
     Context* context = new Context();
 
     /*
-        Initialising SDL. Note we only intiialised Video, since we are targeting emscripten.
+        Initialising SDL. Note we only intiialised Video and game controllers, since we are
+        targeting emscripten.
     */
 
-    i32 ok = SDL_Init(SDL_INIT_VIDEO);
+    i32 ok = SDL_Init(SDL_INIT_VIDEO | SDL_INIT_GAMECONTROLLER);
     CX_ASSERT(ok == 0, "SDL failed to initialise.");
 
     /*
@@ -47,11 +45,10 @@ Context* platform_init() {
     SDL_SetRenderDrawBlendMode(context->Renderer, SDL_BLENDMODE_BLEND);
 
     /*
-        Initialise SoLoud engine.
+        Initialise audio, which starts the audio thread, see audio.hpp.
     */
 
-    context->AudioEngine.init();
-
+    context->Audio = audio_create();
 
     /*
         Initialise SDL_TTF.
@@ -66,6 +63,13 @@ Context* platform_init() {
 
     context->IsRunning = true;
     context->Inputs = new PlayerInputs();
+    context->InputEvents = new InputQueue();
+
+    context->Bindings = new KeyBindings();
+    keybinds_set_defaults(*context->Bindings);
+    if (!keybinds_load(*context->Bindings, KEYBIND_CONFIG_PATH)) {
+        CX_INFO("Using the default key bindings.");
+    }
     context->Game = new Game();
     context->MainClock = new Utils::Clock();
 
@@ -83,6 +87,7 @@ Context* platform_init() {
 void platform_shutdown(Context* context) {
 
     game_shutdown(context);
+    audio_destroy(context->Audio);
 
     TTF_Quit();
 
@@ -90,8 +95,13 @@ void platform_shutdown(Context* context) {
     SDL_DestroyWindow(context->WindowHandle);
     SDL_Quit();
 
+    // Fonts and sounds read straight out of the archive, so it goes last.
+    archive_close(&context->Assets);
+
     delete context->Game;
     delete context->Inputs;
+    delete context->InputEvents;
+    delete context->Bindings;
     delete context;
     context = nullptr;
 }
@@ -110,97 +120,148 @@ void platform_main_loop(void* memory) {
     
     platform_process_events(context);
     game_update_and_render(context, dt);
+    audio_flush(context->Audio);
 
     platform_swap_buffers(context->Renderer);
 }
 
+u32 platform_get_time_ms() {
+    return SDL_GetTicks();
+}
+
+bool platform_find_asset(Context* context, const char* name, const u8** data, u32* size) {
+    return archive_find(&context->Assets, name, data, size);
+}
+
+/*
+    Fonts in the archive are handed to SDL_ttf as a read-only view of the mapping, which it reads
+    glyphs from as it needs them, so the file is never copied.
+*/
+
+TTF_Font* platform_open_font(Context* context, const char* name, i32 size) {
+    const u8* data;
+    u32 dataSize;
+    if (platform_find_asset(context, name, &data, &dataSize)) {
+        return TTF_OpenFontRW(SDL_RWFromConstMem(data, (i32)dataSize), 1, size);
+    }
+    return TTF_OpenFont(name, size);
+}
+
+/*
+    Parses the font once and renders every printable glyph side by side into one white surface.
+    Only SDL_ttf and surfaces are involved, so this is safe on the loader thread; the texture is
+    made afterwards on the render thread by platform_upload_font.
+*/
+
+bool platform_bake_font(Context* context, const char* name, i32 nativeSize, BitmapFont* font) {
+    memset(font, 0, sizeof(*font));
+
+    TTF_Font* ttf = platform_open_font(context, name, nativeSize);
+    if (!ttf) {
+        return false;
+    }
+
+    SDL_Surface* glyphs[FONT_GLYPH_COUNT];
+    font->Height = TTF_FontHeight(ttf);
+    i32 width = 0;
+    for (u32 i = 0; i < FONT_GLYPH_COUNT; i++) {
+        u16 ch = (u16)(FONT_FIRST_GLYPH + i);
+        glyphs[i] = TTF_RenderGlyph_Blended(ttf, ch, { 255, 255, 255, 255 });
+        TTF_GlyphMetrics(ttf, ch, NULL, NULL, NULL, NULL, &font->Advances[i]);
+
+        i32 glyphWidth = glyphs[i] ? glyphs[i]->w : 0;
+        i32 glyphHeight = glyphs[i] ? glyphs[i]->h : 0;
+        font->Glyphs[i] = { width, 0, glyphWidth, glyphHeight };
+        width += glyphWidth;
+    }
+    TTF_CloseFont(ttf);
+
+    font->Pixels = SDL_CreateRGBSurfaceWithFormat(0, width > 0 ? width : 1, font->Height, 32, SDL_PIXELFORMAT_RGBA32);
+    for (u32 i = 0; i < FONT_GLYPH_COUNT; i++) {
+        if (!glyphs[i]) {
+            continue;
+        }
+        if (font->Pixels) {
+            // Copy coverage straight into the atlas rather than blending it onto nothing.
+            SDL_SetSurfaceBlendMode(glyphs[i], SDL_BLENDMODE_NONE);
+            SDL_BlitSurface(glyphs[i], NULL, font->Pixels, &font->Glyphs[i]);
+        }
+        SDL_FreeSurface(glyphs[i]);
+    }
+    return font->Pixels != NULL;
+}
+
+void platform_upload_font(SDL_Renderer* renderer, BitmapFont* font) {
+    font->Atlas = SDL_CreateTextureFromSurface(renderer, font->Pixels);
+    SDL_SetTextureBlendMode(font->Atlas, SDL_BLENDMODE_BLEND);
+    SDL_FreeSurface(font->Pixels);
+    font->Pixels = NULL;
+}
+
+void platform_free_font(BitmapFont* font) {
+    if (font->Pixels) {
+        SDL_FreeSurface(font->Pixels);
+    }
+    if (font->Atlas) {
+        SDL_DestroyTexture(font->Atlas);
+    }
+    memset(font, 0, sizeof(*font));
+}
+
+/*
+    Updates the frame's KeyState and queues the change with its SDL timestamp. OS key repeats
+    only reach KeyState: auto-repeat in game is the simulation's job. With several bindings on
+    one action, only the first down and the last up count.
+*/
+
+static void platform_key_event(Context* context, u32 key, bool isDown, bool isRepeat, u32 timestamp) {
+    if (key == KEYBIND_NONE || (!isRepeat && !keybinds_press(*context->Bindings, key, isDown))) {
+        return;
+    }
+
+    input_set_keystate(input_get_keystate(*context->Inputs, key), isDown, isRepeat);
+    if (!isRepeat && !input_queue_push(*context->InputEvents, { timestamp, (u8)key, isDown })) {
+        CX_WARN("Input queue full, dropped a key event.");
+    }
+}
+
 void platform_process_events(Context* context) {
-    context->Inputs->Left.TransitionCount = 0;
-    context->Inputs->Right.TransitionCount = 0;
-    context->Inputs->Up.TransitionCount = 0;
-    context->Inputs->Down.TransitionCount = 0;
-    context->Inputs->Space.TransitionCount = 0;
-    context->Inputs->Back.TransitionCount = 0;
+    for (u32 key = 0; key < INPUT_KEY_COUNT; key++) {
+        input_get_keystate(*context->Inputs, key).TransitionCount = 0;
+    }
 
     SDL_Event e;
     while (SDL_PollEvent(&e)) {
         switch (e.type) {
             case SDL_QUIT:
                 platform_quit(context);
-            case SDL_KEYDOWN:
-                switch (e.key.keysym.sym) {
-                    case SDLK_a:
-                        input_set_keystate(context->Inputs->Left, true, (e.key.repeat != 0));
-                        break;
-                    case SDLK_d:
-                        input_set_keystate(context->Inputs->Right, true, (e.key.repeat != 0));
-                        break;
-                    case SDLK_s:
-                        input_set_keystate(context->Inputs->Down, true, (e.key.repeat != 0));
-                        break;
-                    case SDLK_w:
-                        input_set_keystate(context->Inputs->Up, true, (e.key.repeat != 0));
-                        break;
-                    case SDLK_LEFT:
-                        input_set_keystate(context->Inputs->Left, true, (e.key.repeat != 0));
-                        break;
-                    case SDLK_RIGHT:
-                        input_set_keystate(context->Inputs->Right, true, (e.key.repeat != 0));
-                        break;
-                    case SDLK_DOWN:
-                        input_set_keystate(context->Inputs->Down, true, (e.key.repeat != 0));
-                        break;
-                    case SDLK_UP:
-                        input_set_keystate(context->Inputs->Up, true, (e.key.repeat != 0));
-                        break;
-                    case SDLK_SPACE:
-                        input_set_keystate(context->Inputs->Space, true, (e.key.repeat != 0));
-                        break;
-                    case SDLK_ESCAPE:
-                        input_set_keystate(context->Inputs->Back, true, (e.key.repeat != 0));
-                        break;
-                    case SDLK_e:
-                        input_set_keystate(context->Inputs->Swap, true, (e.key.repeat != 0));
-                        break;
-                }
                 break;
+            case SDL_KEYDOWN:
             case SDL_KEYUP:
-                switch (e.key.keysym.sym) {
-                    case SDLK_a:
-                        input_set_keystate(context->Inputs->Left, false, (e.key.repeat != 0));
-                        break;
-                    case SDLK_d:
-                        input_set_keystate(context->Inputs->Right, false, (e.key.repeat != 0));
-                        break;
-                    case SDLK_s:
-                        input_set_keystate(context->Inputs->Down, false, (e.key.repeat != 0));
-                        break;
-                    case SDLK_w:
-                        input_set_keystate(context->Inputs->Up, false, (e.key.repeat != 0));
-                        break;
-                    case SDLK_LEFT:
-                        input_set_keystate(context->Inputs->Left, false, (e.key.repeat != 0));
-                        break;
-                    case SDLK_RIGHT:
-                        input_set_keystate(context->Inputs->Right, false, (e.key.repeat != 0));
-                        break;
-                    case SDLK_DOWN:
-                        input_set_keystate(context->Inputs->Down, false, (e.key.repeat != 0));
-                        break;
-                    case SDLK_UP:
-                        input_set_keystate(context->Inputs->Up, false, (e.key.repeat != 0));
-                        break;
-                    case SDLK_SPACE:
-                        input_set_keystate(context->Inputs->Space, false, (e.key.repeat != 0));
-                        break;
-                    case SDLK_ESCAPE:
-                        input_set_keystate(context->Inputs->Back, false, (e.key.repeat != 0));
-                        break;
-                    case SDLK_e:
-                        input_set_keystate(context->Inputs->Swap, false, (e.key.repeat != 0));
-                        break;
+                platform_key_event(
+                    context,
+                    context->Bindings->Scancodes[e.key.keysym.scancode],
+                    e.type == SDL_KEYDOWN,
+                    e.key.repeat != 0,
+                    e.key.timestamp
+                );
+                break;
+            case SDL_CONTROLLERBUTTONDOWN:
+            case SDL_CONTROLLERBUTTONUP:
+                if (e.cbutton.button < SDL_CONTROLLER_BUTTON_MAX) {
+                    platform_key_event(
+                        context,
+                        context->Bindings->Buttons[e.cbutton.button],
+                        e.type == SDL_CONTROLLERBUTTONDOWN,
+                        false,
+                        e.cbutton.timestamp
+                    );
                 }
                 break;
+            case SDL_CONTROLLERDEVICEADDED:
+                // Opened for as long as the game runs, SDL closes it on quit.
+                SDL_GameControllerOpen(e.cdevice.which);
+                break;
         }
     }
 }
@@ -215,119 +276,61 @@ void platform_swap_buffers(SDL_Renderer* renderer) {
     SDL_RenderClear(renderer);
 }
 
-void draw_quad_filled(SDL_Renderer* renderer, Vec4 color, Rect2D rect) {
-    SDL_Color col = color_from_vec4(color);
-    SDL_SetRenderDrawColor(renderer, col.r, col.g, col.b, col.a);
+void draw_quad_filled(SDL_Renderer* renderer, u8 color, Rect2D rect) {
+    platform_set_draw_color(renderer, color);
     SDL_Rect drawRect = { (i32)rect.x, (i32)rect.y, (i32)rect.w, (i32)rect.h };
     SDL_RenderFillRect(renderer, &drawRect);
 }
 
-void draw_quad_outline(SDL_Renderer* renderer, Vec4 color, Rect2D rect) {
-    SDL_Color col = color_from_vec4(color);
-    SDL_SetRenderDrawColor(renderer, col.r, col.g, col.b, col.a);
+void draw_quad_outline(SDL_Renderer* renderer, u8 color, Rect2D rect) {
+    platform_set_draw_color(renderer, color);
     SDL_Rect drawRect = { (i32)rect.x, (i32)rect.y, (i32)rect.w, (i32)rect.h };
     SDL_RenderDrawRect(renderer, &drawRect);
 }
 
 /*
-    Probably some cleaner way to do this but it works perfectly fine for now.
+    Text from a BitmapFont: one copy out of the atlas per character, tinted with the texture's
+    colour mod. SDL scales textures with nearest filtering unless told otherwise, which keeps
+    the pixels square at every scale.
 */
 
-void draw_text(SDL_Renderer* renderer, TTF_Font* font, const char* text, Vec4 color, i32 left, i32 top) {
-    SDL_Color textColor = color_from_vec4(color);
-
-    SDL_Surface* surface = TTF_RenderText_Blended(
-        font,
-        text,
-        textColor
-    );
-
-    SDL_Texture* tex = SDL_CreateTextureFromSurface(
-        renderer,
-        surface
-    );
-
-    SDL_FreeSurface(surface);
-
-    i32 textWidth;
-    i32 textHeight;
-
-    SDL_QueryTexture(tex, NULL, NULL, &textWidth, &textHeight);
-
-    SDL_Rect dst = {
-        left,
-        top,
-        textWidth,
-        textHeight
-    };
-
-    SDL_RenderCopy(renderer, tex, NULL, &dst);
-
-    SDL_DestroyTexture(tex);
+i32 measure_text(Font font, const char* text) {
+    i32 width = 0;
+    for (const char* c = text; *c; c++) {
+        u32 glyph = (u32)(u8)*c - FONT_FIRST_GLYPH;
+        if (glyph < FONT_GLYPH_COUNT) {
+            width += font.Bitmap->Advances[glyph];
+        }
+    }
+    return width * font.Scale;
 }
 
-void draw_text_centered(SDL_Renderer* renderer, TTF_Font* font, const char* text, Vec4 color, i32 centerX, i32 centerY) {
-    SDL_Color textColor = color_from_vec4(color);
-
-    SDL_Surface* surface = TTF_RenderText_Blended(
-        font,
-        text,
-        textColor
-    );
-
-    SDL_Texture* tex = SDL_CreateTextureFromSurface(
-        renderer,
-        surface
-    );
-
-    SDL_FreeSurface(surface);
-
-    i32 textWidth;
-    i32 textHeight;
-
-    SDL_QueryTexture(tex, NULL, NULL, &textWidth, &textHeight);
-
-    SDL_Rect dst = {
-        centerX - (textWidth / 2),
-        centerY - (textHeight / 2),
-        textWidth,
-        textHeight
-    };
-
-    SDL_RenderCopy(renderer, tex, NULL, &dst);
+void draw_text(SDL_Renderer* renderer, Font font, const char* text, u8 color, i32 left, i32 top) {
+    const BitmapFont* bitmap = font.Bitmap;
+    const PaletteColor& textColor = palette_get(color);
+    SDL_SetTextureColorMod(bitmap->Atlas, textColor.R, textColor.G, textColor.B);
+    SDL_SetTextureAlphaMod(bitmap->Atlas, textColor.A);
+
+    i32 x = left;
+    for (const char* c = text; *c; c++) {
+        u32 glyph = (u32)(u8)*c - FONT_FIRST_GLYPH;
+        if (glyph >= FONT_GLYPH_COUNT) {
+            continue;
+        }
 
-    SDL_DestroyTexture(tex);
+        const SDL_Rect& src = bitmap->Glyphs[glyph];
+        SDL_Rect dst = { x, top, src.w * font.Scale, src.h * font.Scale };
+        SDL_RenderCopy(renderer, bitmap->Atlas, &src, &dst);
+        x += bitmap->Advances[glyph] * font.Scale;
+    }
 }
 
-void draw_text_right_aligned(SDL_Renderer* renderer, TTF_Font* font, const char* text, Vec4 color, i32 right, i32 top) {
-    SDL_Color textColor = color_from_vec4(color);
-
-    SDL_Surface* surface = TTF_RenderText_Blended(
-        font,
-        text,
-        textColor
-    );
-
-    SDL_Texture* tex = SDL_CreateTextureFromSurface(
-        renderer,
-        surface
-    );
-
-    SDL_FreeSurface(surface);
-
-    i32 textWidth;
-    i32 textHeight;
-
-    SDL_QueryTexture(tex, NULL, NULL, &textWidth, &textHeight);
-
-    SDL_Rect dst = {
-        right - textWidth,
-        top,
-        textWidth,
-        textHeight
-    };
-
-    SDL_RenderCopy(renderer, tex, NULL, &dst);
+void draw_text_centered(SDL_Renderer* renderer, Font font, const char* text, u8 color, i32 centerX, i32 centerY) {
+    i32 textWidth = measure_text(font, text);
+    i32 textHeight = font.Bitmap->Height * font.Scale;
+    draw_text(renderer, font, text, color, centerX - (textWidth / 2), centerY - (textHeight / 2));
+}
 
-    SDL_DestroyTexture(tex);
-}
\ No newline at end of file
+void draw_text_right_aligned(SDL_Renderer* renderer, Font font, const char* text, u8 color, i32 right, i32 top) {
+    draw_text(renderer, font, text, color, right - measure_text(font, text), top);
+}
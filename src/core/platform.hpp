@@ -3,11 +3,12 @@
 #include "core/base.h"
 #include "core/utils.hpp"
 #include "core/input.hpp"
+#include "core/audio.hpp"
+#include "core/archive.hpp"
+#include "core/palette.hpp"
 #include "maths/linalg.hpp"
 #include "maths/geometry.hpp"
 
-#include "soloud.h"
-
 #if CORTEX_PLATFORM_WEB
     #include "SDL.h"
     #include "SDL_ttf.h"
@@ -17,6 +18,29 @@
 #endif
 
 struct Game;
+struct KeyBindings;
+
+/*
+    Text comes from a pixel font rasterised once, at the size its pixels are one pixel each,
+    into a single atlas of printable ASCII. Every text size is that atlas drawn at an integer
+    scale, so only one font is ever parsed and glyphs stay crisp.
+*/
+
+#define FONT_FIRST_GLYPH 32
+#define FONT_GLYPH_COUNT 95
+
+struct BitmapFont {
+    SDL_Surface* Pixels;  // Baked glyphs, until platform_upload_font makes them the atlas.
+    SDL_Texture* Atlas;
+    SDL_Rect Glyphs[FONT_GLYPH_COUNT];
+    i32 Advances[FONT_GLYPH_COUNT];
+    i32 Height;
+};
+
+struct Font {
+    const BitmapFont* Bitmap;
+    i32 Scale;
+};
 
 struct Context {
     bool IsRunning;
@@ -24,8 +48,11 @@ struct Context {
     i32 WindowHeight;
     SDL_Window* WindowHandle;
     SDL_Renderer* Renderer;
-    SoLoud::Soloud  AudioEngine;
+    PlatformAudio* Audio;
+    AssetArchive Assets;
     PlayerInputs* Inputs;
+    InputQueue* InputEvents;
+    KeyBindings* Bindings;
     Utils::Clock* MainClock;
     Game* Game;
 };
@@ -40,19 +67,23 @@ void platform_quit(Context* context);
 void platform_main_loop(void* memory);
 
 void platform_process_events(Context* context);
+u32 platform_get_time_ms();
+
+bool platform_find_asset(Context* context, const char* name, const u8** data, u32* size);
+TTF_Font* platform_open_font(Context* context, const char* name, i32 size);
+bool platform_bake_font(Context* context, const char* name, i32 nativeSize, BitmapFont* font);
+void platform_upload_font(SDL_Renderer* renderer, BitmapFont* font);
+void platform_free_font(BitmapFont* font);
 void platform_swap_buffers(SDL_Renderer* renderer);
 
 /*
     Basic platform rendering API
 */
 
-void draw_quad_filled(SDL_Renderer* renderer, Vec4 color, Rect2D rect);
-void draw_quad_outline(SDL_Renderer* renderer, Vec4 color, Rect2D rect);
-void draw_text(SDL_Renderer* renderer, TTF_Font* font, const char* text, Vec4 color, i32 left, i32 bottom);
-void draw_text_centered(SDL_Renderer* renderer, TTF_Font* font, const char* text, Vec4 color, i32 centerX, i32 centerY);
-void draw_text_right_aligned(SDL_Renderer* renderer, TTF_Font* font, const char* text, Vec4 color, i32 right, i32 top);
-
-/*
-    TODO: Add some sort of platform Audio API to pull direct soloud calls out of game layer.
-*/
+void draw_quad_filled(SDL_Renderer* renderer, u8 color, Rect2D rect);
+void draw_quad_outline(SDL_Renderer* renderer, u8 color, Rect2D rect);
+i32 measure_text(Font font, const char* text);
+void draw_text(SDL_Renderer* renderer, Font font, const char* text, u8 color, i32 left, i32 bottom);
+void draw_text_centered(SDL_Renderer* renderer, Font font, const char* text, u8 color, i32 centerX, i32 centerY);
+void draw_text_right_aligned(SDL_Renderer* renderer, Font font, const char* text, u8 color, i32 right, i32 top);
 
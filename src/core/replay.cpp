@@ -0,0 +1,78 @@
+#include "core/replay.hpp"
+
+void replay_reset(Replay* replay) {
+    replay->Count = 0;
+    replay->Score = 0;
+}
+
+void replay_free(Replay* replay) {
+    delete[] replay->Pieces;
+    replay->Pieces = nullptr;
+    replay->Count = 0;
+    replay->Capacity = 0;
+    replay->Score = 0;
+}
+
+void replay_append(Replay* replay, const ReplayPiece& piece) {
+    if (replay->Count == replay->Capacity) {
+        u32 capacity = replay->Capacity ? replay->Capacity * 2 : 256;
+        ReplayPiece* pieces = new ReplayPiece[capacity];
+        if (replay->Count) {
+            memcpy(pieces, replay->Pieces, sizeof(ReplayPiece) * replay->Count);
+        }
+        delete[] replay->Pieces;
+        replay->Pieces = pieces;
+        replay->Capacity = capacity;
+    }
+    replay->Pieces[replay->Count++] = piece;
+}
+
+bool replay_save(const Replay* replay, const char* path) {
+    FILE* file = fopen(path, "wb");
+    if (!file) {
+        CX_ERROR("Failed to open %s for writing.", path);
+        return false;
+    }
+
+    ReplayHeader header = {};
+    memcpy(header.Magic, REPLAY_MAGIC, sizeof(header.Magic));
+    header.Version = REPLAY_VERSION;
+    header.PieceCount = replay->Count;
+    header.Score = replay->Score;
+
+    bool ok = fwrite(&header, sizeof(header), 1, file) == 1
+        && fwrite(replay->Pieces, sizeof(ReplayPiece), replay->Count, file) == replay->Count;
+    fclose(file);
+    return ok;
+}
+
+bool replay_load(const char* path, Replay* replay) {
+    FILE* file = fopen(path, "rb");
+    if (!file) {
+        CX_ERROR("Failed to open %s.", path);
+        return false;
+    }
+
+    ReplayHeader header;
+    if (fread(&header, sizeof(header), 1, file) != 1
+        || memcmp(header.Magic, REPLAY_MAGIC, sizeof(header.Magic)) != 0
+        || header.Version != REPLAY_VERSION) {
+        CX_ERROR("%s is not a replay.", path);
+        fclose(file);
+        return false;
+    }
+
+    replay_reset(replay);
+    replay->Score = header.Score;
+    for (u32 i = 0; i < header.PieceCount; i++) {
+        ReplayPiece piece;
+        if (fread(&piece, sizeof(piece), 1, file) != 1) {
+            CX_ERROR("%s is truncated.", path);
+            fclose(file);
+            return false;
+        }
+        replay_append(replay, piece);
+    }
+    fclose(file);
+    return true;
+}
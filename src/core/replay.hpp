@@ -0,0 +1,48 @@
+#pragma once
+
+#include "core/base.h"
+
+/*
+    Per-piece record of a played game: where each piece locked and how many keys it took to
+    get there. Enough to rebuild the field piece by piece and to judge finesse (see finesse.hpp).
+    On disk a replay is a 24 byte header followed by the pieces.
+*/
+
+#define REPLAY_MAGIC "TTRSRPLY"
+#define REPLAY_VERSION 1
+
+struct ReplayHeader {
+    char Magic[8];
+    u32 Version;
+    u32 PieceCount;
+    u32 Score;
+    u32 Reserved;
+};
+
+STATIC_ASSERT(sizeof(ReplayHeader) == 24, "Replay header layout must not change.");
+
+struct ReplayPiece {
+    u8 ShapeID;
+    u8 StartRotation;   // Rotation the piece entered the field in (a swapped back piece keeps its own).
+    u8 Rotation;        // Where it locked, as a sim Placement.
+    i8 X;
+    i8 Y;
+    u8 RotatePresses;
+    u8 MovePresses;     // Left/right presses, a held key only counts once however far it slides.
+    u8 Reserved;
+};
+
+STATIC_ASSERT(sizeof(ReplayPiece) == 8, "Replay piece layout must not change.");
+
+struct Replay {
+    ReplayPiece* Pieces;
+    u32 Count;
+    u32 Capacity;
+    u32 Score;
+};
+
+void replay_reset(Replay* replay);
+void replay_free(Replay* replay);
+void replay_append(Replay* replay, const ReplayPiece& piece);
+bool replay_save(const Replay* replay, const char* path);
+bool replay_load(const char* path, Replay* replay);
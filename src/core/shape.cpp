@@ -1,37 +1,143 @@
 #include "core/shape.hpp"
 
+static Shape s_Shapes[SHAPE_COUNT] = {
+    {
+        .Data = {
+            0, 0, 0, 0,
+            0, 0, 0, 0,
+            0, 0, 0, 0,
+            0, 0, 0, 0
+        },
+        .ID = 0,        
+    },
+    {
+        .Data = {
+            0, 0, 0, 0,
+            1, 1, 1, 1,
+            0, 0, 0, 0,
+            0, 0, 0, 0
+        },
+        .ID = 1,
+    },
+    {
+        .Data = {
+            0, 0, 0, 0,
+            0, 1, 1, 0,
+            0, 1, 1, 0,
+            0, 0, 0, 0
+        },
+        .ID = 2,
+    },
+    {
+        .Data = {
+            0, 0, 0, 0,
+            0, 1, 0, 0,
+            0, 1, 1, 1,
+            0, 0, 0, 0
+        },
+        .ID = 3,
+    },
+    {
+        .Data = {
+            0, 0, 0, 0,
+            0, 1, 1, 1,
+            0, 1, 0, 0,
+            0, 0, 0, 0
+        },
+        .ID = 4,
+    },
+    {
+        .Data = {
+            0, 0, 0, 0,
+            0, 0, 1, 0,
+            0, 1, 1, 1,
+            0, 0, 0, 0
+        },
+        .ID = 5,
+    },
+    {
+        .Data = {
+            0, 0, 0, 0,
+            0, 0, 1, 1,
+            0, 1, 1, 0,
+            0, 0, 0, 0
+        },
+        .ID = 6,
+    },
+    {
+        .Data = {
+            0, 0, 0, 0,
+            0, 1, 1, 0,
+            0, 0, 1, 1,
+            0, 0, 0, 0
+        },
+        .ID = 7,
+    },
+};
+
 /*
-    Rotates a shape clockwise in-place
+    Every rotation state of every shape, built once on first use so that headless code
+    (bots, tools) never has to rotate shapes on the fly.
 */
 
-void shape_rotate(Shape& shape) {
-    u32 rotatedData[16] = {};
-    for (i32 i = 0; i < 4; i++) {
-        for (i32 j = 0; j < 4; j++) {
-            rotatedData[j * 4 + (3 - i)] = shape.Data[i * 4 + j];
+struct ShapeRotationTable {
+    Shape Shapes[SHAPE_COUNT][SHAPE_ROTATION_COUNT];
+};
+
+static ShapeRotationTable shape_build_rotation_table() {
+    ShapeRotationTable table;
+    for (u32 id = 0; id < SHAPE_COUNT; id++) {
+        Shape shape = s_Shapes[id];
+        for (u32 r = 0; r < SHAPE_ROTATION_COUNT; r++) {
+            table.Shapes[id][r] = shape;
+            shape_rotate(shape);
         }
     }
-    memcpy(&shape.Data, &rotatedData, 16 * sizeof(u32));
+    return table;
+}
+
+const Shape& shape_get(u32 id) {
+    CX_DEBUGASSERT(id < SHAPE_COUNT, "Shape ID out of range!");
+    return s_Shapes[id];
+}
+
+const Shape& shape_get_rotated(u32 id, u32 rotation) {
+    // Function-local statics are initialised exactly once, even with multiple threads.
+    static const ShapeRotationTable s_RotationTable = shape_build_rotation_table();
+    CX_DEBUGASSERT(id < SHAPE_COUNT, "Shape ID out of range!");
+    return s_RotationTable.Shapes[id][rotation % SHAPE_ROTATION_COUNT];
+}
+
+/*
+    Which clockwise rotation of its shape the data is in, since the game only keeps rotated data.
+*/
+
+u32 shape_get_rotation(const Shape& shape) {
+    for (u32 r = 0; r < SHAPE_ROTATION_COUNT; r++) {
+        if (memcmp(shape.Data, shape_get_rotated(shape.ID, r).Data, sizeof(shape.Data)) == 0) {
+            return r;
+        }
+    }
+    CX_DEBUGASSERT(false, "Shape data is not a rotation of its ID!");
+    return 0;
 }
 
 /*
-    Draws the 128 x 128 shape, where (x, y) is the bottom-left corner
+    Rotates a shape clockwise in-place
 */
 
-void shape_render(SDL_Renderer* renderer, Shape& shape, i32 x, i32 y) {
-    for (i32 j = 0; j < 4; j++) {
-        for (i32 i = 0; i < 4; i++) {
-            if (shape.Data[(j * 4) + i]) {
-                Rect2D rect = {(f32)(x + i * 32), (f32)(y + j * 32), (f32)32, (f32)32};
-                draw_quad_filled(renderer, shape.Color, rect);
-                draw_quad_outline(renderer, {0.0, 0.0, 0.0, 0.4}, rect);
-            }
+void shape_rotate(Shape& shape) {
+    u32 rotatedData[16] = {};
+    for (i32 i = 0; i < 4; i++) {
+        for (i32 j = 0; j < 4; j++) {
+            rotatedData[j * 4 + (3 - i)] = shape.Data[i * 4 + j];
         }
     }
+    memcpy(&shape.Data, &rotatedData, 16 * sizeof(u32));
 }
 
 void shape_swap(Shape& a, Shape& b) {
     Shape temp = a;
     a = b;
     b = temp;
-}
\ No newline at end of file
+}
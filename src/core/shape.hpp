@@ -1,15 +1,24 @@
 #pragma once
 
 #include "core/base.h"
-#include "core/platform.hpp"
-#include "maths/linalg.hpp"
+
+// Number of entries in the shape table, including the empty shape at ID 0.
+#define SHAPE_COUNT 8
+
+// Field cell value of garbage rows (see field_insert_garbage), which belong to no shape.
+#define SHAPE_GARBAGE_ID SHAPE_COUNT
+
+// Number of distinct clockwise rotation states for any shape.
+#define SHAPE_ROTATION_COUNT 4
 
 struct Shape {
     u32 Data[16];
-    Vec4 Color;
     u32 ID;
 };
 
+const Shape& shape_get(u32 id);
+const Shape& shape_get_rotated(u32 id, u32 rotation);
+u32 shape_get_rotation(const Shape& shape);
+
 void shape_rotate(Shape& shape);
-void shape_render(SDL_Renderer* renderer, Shape& shape, i32 x, i32 y);
-void shape_swap(Shape& a, Shape& b);
\ No newline at end of file
+void shape_swap(Shape& a, Shape& b);
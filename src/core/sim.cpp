@@ -0,0 +1,253 @@
+#include "core/sim.hpp"
+
+#include "maths/random.hpp"
+
+static u32 s_LineClearScores[5] = {
+    0,   // No clear
+    100, // Single
+    300, // Double
+    500, // Triple
+    800  // Tetris
+};
+
+u32 sim_line_clear_score(u32 lineCount) {
+    CX_DEBUGASSERT(lineCount <= 4, "Cannot clear more than four lines with one piece!");
+    return s_LineClearScores[lineCount];
+}
+
+u32 sim_random_shape_id(u32& seed) {
+    return RandU32(seed, 1, SHAPE_COUNT - 1);
+}
+
+void sim_reset(SimState& state, u32 seed) {
+    field_clear(state.Field);
+    state.Seed = seed;
+    state.CurrentID = sim_random_shape_id(state.Seed);
+    state.NextID = sim_random_shape_id(state.Seed);
+    state.Score = 0;
+    state.Lines = 0;
+    state.Pieces = 0;
+    state.IsOver = false;
+}
+
+/*
+    Placement enumeration runs for every candidate of every move a bot makes, so rather than go
+    through field_check_collision's 4x4 scan it works from a table of each rotation's four cells
+    and the column heights of the field.
+*/
+
+struct SimShapeInfo {
+    i8 CellX[4];
+    i8 CellY[4];
+    i8 Bottom[4]; // Lowest cell in each column of the 4x4 box, -1 if the column is empty.
+    bool IsDuplicate; // Same cells as an earlier rotation (the O piece, for instance).
+};
+
+struct SimShapeTable {
+    SimShapeInfo Info[SHAPE_COUNT][SHAPE_ROTATION_COUNT];
+};
+
+static SimShapeTable sim_build_shape_table() {
+    SimShapeTable table = {};
+    for (u32 id = 0; id < SHAPE_COUNT; id++) {
+        for (u32 r = 0; r < SHAPE_ROTATION_COUNT; r++) {
+            const Shape& shape = shape_get_rotated(id, r);
+            SimShapeInfo& info = table.Info[id][r];
+            u32 count = 0;
+            for (i32 i = 0; i < 4; i++) {
+                info.Bottom[i] = -1;
+                for (i32 j = 3; j >= 0; j--) {
+                    if (shape.Data[(j * 4) + i] && count < 4) {
+                        // Same (row, col) mapping as field_place_shape.
+                        info.CellX[count] = (i8)i;
+                        info.CellY[count] = (i8)(3 - j);
+                        if (info.Bottom[i] < 0) {
+                            info.Bottom[i] = (i8)(3 - j);
+                        }
+                        count++;
+                    }
+                }
+            }
+            for (u32 k = 0; k < r; k++) {
+                if (memcmp(shape.Data, shape_get_rotated(id, k).Data, sizeof(shape.Data)) == 0) {
+                    info.IsDuplicate = true;
+                }
+            }
+        }
+    }
+    return table;
+}
+
+static const SimShapeInfo& sim_get_shape_info(u32 id, u32 rotation) {
+    static const SimShapeTable s_ShapeTable = sim_build_shape_table();
+    return s_ShapeTable.Info[id][rotation];
+}
+
+static bool sim_check_collision(const u32* field, const SimShapeInfo& info, i32 x, i32 y) {
+    for (u32 k = 0; k < 4; k++) {
+        i32 col = x + info.CellX[k];
+        i32 row = y + info.CellY[k];
+        if (col < 0 || col >= FIELD_WIDTH || row < 0) {
+            return true;
+        }
+        if (row < FIELD_HEIGHT && field[row * FIELD_WIDTH + col]) {
+            return true;
+        }
+    }
+    return false;
+}
+
+/*
+    Hard drop landing row. Straight from the column heights when the piece starts above the whole
+    stack under it, otherwise (only possible right at the top of the field) step down as the game does.
+*/
+
+static i32 sim_drop(const u32* field, const i32* heights, const SimShapeInfo& info, i32 x) {
+    i32 y = -4; // Below any possible landing.
+    for (i32 i = 0; i < 4; i++) {
+        if (info.Bottom[i] >= 0) {
+            i32 landing = heights[x + i] - info.Bottom[i];
+            y = landing > y ? landing : y;
+        }
+    }
+    if (y <= SIM_SPAWN_Y) {
+        return y;
+    }
+
+    y = SIM_SPAWN_Y;
+    while (!sim_check_collision(field, info, x, y - 1)) {
+        y--;
+    }
+    return y;
+}
+
+/*
+    Enumerates every placement reachable from the spawn with the moves the player has: clockwise
+    rotations in place, then single column slides, then a hard drop. Rotations that leave the
+    shape data unchanged are skipped so each landing is only listed once.
+*/
+
+static u32 sim_get_placements_for_shape(const u32* field, const i32* heights, u32 id, bool swap, Placement* placements) {
+    u32 count = 0;
+    for (u32 r = 0; r < SHAPE_ROTATION_COUNT; r++) {
+        const SimShapeInfo& info = sim_get_shape_info(id, r);
+
+        // The game only ever rotates clockwise, so once a rotation is blocked the rest are too.
+        if (sim_check_collision(field, info, SIM_SPAWN_X, SIM_SPAWN_Y)) {
+            break;
+        }
+        if (info.IsDuplicate) {
+            continue;
+        }
+
+        i32 minX = SIM_SPAWN_X;
+        while (minX > SIM_MIN_X && !sim_check_collision(field, info, minX - 1, SIM_SPAWN_Y)) {
+            minX--;
+        }
+
+        i32 maxX = SIM_SPAWN_X;
+        while (maxX < SIM_MAX_X && !sim_check_collision(field, info, maxX + 1, SIM_SPAWN_Y)) {
+            maxX++;
+        }
+
+        for (i32 x = minX; x <= maxX; x++) {
+            Placement& placement = placements[count++];
+            placement.X = (i8)x;
+            placement.Y = (i8)sim_drop(field, heights, info, x);
+            placement.Rotation = (u8)r;
+            placement.Swap = swap;
+        }
+    }
+    return count;
+}
+
+u32 sim_get_placements(const SimState& state, Placement* placements, bool allowSwap) {
+    if (state.IsOver) {
+        return 0;
+    }
+
+    // Padded by the width of a shape box on both sides so drops near the walls need no bounds checks.
+    i32 paddedHeights[FIELD_WIDTH + 8] = {};
+    i32* heights = paddedHeights - SIM_MIN_X;
+    for (i32 col = 0; col < FIELD_WIDTH; col++) {
+        for (i32 row = FIELD_HEIGHT - 1; row >= 0; row--) {
+            if (state.Field[row * FIELD_WIDTH + col]) {
+                heights[col] = row + 1;
+                break;
+            }
+        }
+    }
+
+    u32 count = sim_get_placements_for_shape(state.Field, heights, state.CurrentID, false, placements);
+    if (allowSwap && state.NextID != state.CurrentID) {
+        count += sim_get_placements_for_shape(state.Field, heights, state.NextID, true, placements + count);
+    }
+    return count;
+}
+
+/*
+    Writes the rows (see field_to_rows) that would result from a placement into `result`, and
+    returns the lines cleared. `rows` must be the packed form of the state's field. Working on
+    36 bytes of bitmasks instead of the full field is what keeps scoring candidates cheap.
+*/
+
+u32 sim_preview_placement(const SimState& state, const u16* rows, const Placement& placement, u16* result) {
+    u32 id = placement.Swap ? state.NextID : state.CurrentID;
+    const SimShapeInfo& info = sim_get_shape_info(id, placement.Rotation);
+
+    u16 placed[FIELD_HEIGHT];
+    memcpy(placed, rows, sizeof(placed));
+    for (u32 k = 0; k < 4; k++) {
+        i32 row = placement.Y + info.CellY[k];
+        // Cells landing above the top of the field are lost, as in field_place_shape.
+        if (row < FIELD_HEIGHT) {
+            placed[row] |= (u16)(1 << (placement.X + info.CellX[k]));
+        }
+    }
+
+    u32 lineCount = 0;
+    u32 count = 0;
+    for (u32 row = 0; row < FIELD_HEIGHT; row++) {
+        if (placed[row] == SIM_FULL_ROW) {
+            lineCount++;
+        } else {
+            result[count++] = placed[row];
+        }
+    }
+    while (count < FIELD_HEIGHT) {
+        result[count++] = 0;
+    }
+    return lineCount;
+}
+
+u32 sim_apply_placement(SimState& state, const Placement& placement) {
+    CX_DEBUGASSERT(!state.IsOver, "Cannot place a piece once the game is over!");
+
+    // Swapping exchanges the current and next pieces, exactly as the Swap input does in game.
+    if (placement.Swap) {
+        u32 temp = state.CurrentID;
+        state.CurrentID = state.NextID;
+        state.NextID = temp;
+    }
+
+    field_place_shape(
+        state.Field,
+        shape_get_rotated(state.CurrentID, placement.Rotation),
+        placement.X,
+        placement.Y
+    );
+
+    u32 lineCount = field_clear_lines(state.Field, nullptr);
+    state.Score += sim_line_clear_score(lineCount);
+    state.Lines += lineCount;
+    state.Pieces ++;
+
+    state.CurrentID = state.NextID;
+    state.NextID = sim_random_shape_id(state.Seed);
+
+    if (field_check_collision(state.Field, shape_get(state.CurrentID), SIM_SPAWN_X, SIM_SPAWN_Y)) {
+        state.IsOver = true;
+    }
+
+    return lineCount;
+}
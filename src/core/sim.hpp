@@ -0,0 +1,52 @@
+#pragma once
+
+#include "core/base.h"
+#include "core/field.hpp"
+#include "core/shape.hpp"
+
+/*
+    Headless, placement-level version of the rules in game.cpp. There is no Context, no timers
+    and no rendering here, just enough state to play a game one piece at a time, which is what
+    bots and offline tools need. Pieces reach their placement exactly as a player would reach it
+    in gamestate_playing_update: rotate at the spawn, slide sideways, then hard drop.
+*/
+
+// Spawn position of every new piece, matches game_reset_cursor.
+#define SIM_SPAWN_X 3
+#define SIM_SPAWN_Y 16
+
+// Leftmost and rightmost cursor columns a 4x4 shape can occupy.
+#define SIM_MIN_X -3
+#define SIM_MAX_X (FIELD_WIDTH - 1)
+
+// Row bitmask with every column filled, see field_to_rows.
+#define SIM_FULL_ROW ((1 << FIELD_WIDTH) - 1)
+
+// Upper bound on the placements for one piece: every rotation, every column, with and without a swap.
+#define SIM_MAX_PLACEMENTS (2 * SHAPE_ROTATION_COUNT * (SIM_MAX_X - SIM_MIN_X + 1))
+
+struct Placement {
+    i8 X;
+    i8 Y;
+    u8 Rotation;
+    u8 Swap;
+};
+
+struct SimState {
+    u32 Field[FIELD_SIZE];
+    u32 CurrentID;
+    u32 NextID;
+    u32 Seed;
+    u32 Score;
+    u32 Lines;
+    u32 Pieces;
+    bool IsOver;
+};
+
+u32 sim_line_clear_score(u32 lineCount);
+u32 sim_random_shape_id(u32& seed);
+
+void sim_reset(SimState& state, u32 seed);
+u32 sim_get_placements(const SimState& state, Placement* placements, bool allowSwap);
+u32 sim_preview_placement(const SimState& state, const u16* rows, const Placement& placement, u16* result);
+u32 sim_apply_placement(SimState& state, const Placement& placement);
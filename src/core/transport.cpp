@@ -0,0 +1,160 @@
+#include "core/transport.hpp"
+
+#include "maths/random.hpp"
+
+#include <arpa/inet.h>
+#include <fcntl.h>
+#include <netinet/in.h>
+#include <sys/socket.h>
+#include <unistd.h>
+
+/*
+    UDP socket
+*/
+
+struct NetSocket {
+    int Handle;
+};
+
+NetSocket* net_socket_open(u16 localPort, const char* remoteAddress, u16 remotePort) {
+    int handle = socket(AF_INET, SOCK_DGRAM, 0);
+    if (handle < 0) {
+        CX_ERROR("Failed to create a UDP socket.");
+        return nullptr;
+    }
+
+    sockaddr_in local = {};
+    local.sin_family = AF_INET;
+    local.sin_addr.s_addr = htonl(INADDR_ANY);
+    local.sin_port = htons(localPort);
+
+    sockaddr_in remote = {};
+    remote.sin_family = AF_INET;
+    remote.sin_port = htons(remotePort);
+
+    // Connecting a datagram socket fixes the peer, so plain send/recv can be used and packets
+    // from anywhere else are filtered out.
+    if (inet_pton(AF_INET, remoteAddress, &remote.sin_addr) != 1
+        || bind(handle, (sockaddr*)&local, sizeof(local)) != 0
+        || connect(handle, (sockaddr*)&remote, sizeof(remote)) != 0
+        || fcntl(handle, F_SETFL, fcntl(handle, F_GETFL, 0) | O_NONBLOCK) != 0) {
+        CX_ERROR("Failed to open UDP port %u to %s:%u.", localPort, remoteAddress, remotePort);
+        close(handle);
+        return nullptr;
+    }
+
+    NetSocket* result = new NetSocket();
+    result->Handle = handle;
+    return result;
+}
+
+void net_socket_close(NetSocket* socket) {
+    close(socket->Handle);
+    delete socket;
+}
+
+static bool net_socket_send(void* user, const u8* data, u32 size) {
+    NetSocket* socket = (NetSocket*)user;
+    return send(socket->Handle, data, size, 0) == (ssize_t)size;
+}
+
+static u32 net_socket_receive(void* user, u8* data, u32 capacity) {
+    NetSocket* socket = (NetSocket*)user;
+
+    // Nothing waiting, or an ICMP error left over from the peer not being up yet: both read as no packet.
+    ssize_t size = recv(socket->Handle, data, capacity, 0);
+    return size > 0 ? (u32)size : 0;
+}
+
+NetTransport net_socket_transport(NetSocket* socket) {
+    NetTransport transport;
+    transport.User = socket;
+    transport.Send = net_socket_send;
+    transport.Receive = net_socket_receive;
+    return transport;
+}
+
+/*
+    Latency and loss injection
+*/
+
+#define NET_LOSSY_MAX_QUEUED 256
+
+struct NetDelayedPacket {
+    f64 DeliverAt;
+    u32 Size;
+    u8 Data[NET_MAX_PACKET];
+};
+
+struct NetLossy {
+    NetTransport Inner;
+    NetConditions Conditions;
+    u32 Seed;
+    f64 Now;
+    u32 QueuedCount;
+    NetDelayedPacket Queued[NET_LOSSY_MAX_QUEUED];
+};
+
+NetLossy* net_lossy_create(NetTransport inner, const NetConditions& conditions) {
+    NetLossy* lossy = new NetLossy();
+    lossy->Inner = inner;
+    lossy->Conditions = conditions;
+    lossy->Seed = conditions.Seed;
+    lossy->Now = 0.0;
+    lossy->QueuedCount = 0;
+    return lossy;
+}
+
+void net_lossy_destroy(NetLossy* lossy) {
+    delete lossy;
+}
+
+// Hands every packet that is due over to the inner transport. Order among due packets does not
+// matter, the delays have already shuffled them.
+static void net_lossy_flush(NetLossy* lossy) {
+    for (u32 i = 0; i < lossy->QueuedCount;) {
+        NetDelayedPacket& packet = lossy->Queued[i];
+        if (packet.DeliverAt <= lossy->Now) {
+            lossy->Inner.Send(lossy->Inner.User, packet.Data, packet.Size);
+            packet = lossy->Queued[--lossy->QueuedCount];
+        } else {
+            i++;
+        }
+    }
+}
+
+void net_lossy_set_time(NetLossy* lossy, f64 now) {
+    lossy->Now = now;
+    net_lossy_flush(lossy);
+}
+
+static bool net_lossy_send(void* user, const u8* data, u32 size) {
+    NetLossy* lossy = (NetLossy*)user;
+    if (RandFloat(lossy->Seed) < lossy->Conditions.Loss) {
+        return true; // Lost on the way, as far as the sender can tell it went out fine.
+    }
+    if (lossy->QueuedCount == NET_LOSSY_MAX_QUEUED || size > NET_MAX_PACKET) {
+        return false;
+    }
+
+    NetDelayedPacket& packet = lossy->Queued[lossy->QueuedCount++];
+    packet.DeliverAt = lossy->Now + lossy->Conditions.Latency + lossy->Conditions.Jitter * RandFloat(lossy->Seed);
+    packet.Size = size;
+    memcpy(packet.Data, data, size);
+    net_lossy_flush(lossy);
+    return true;
+}
+
+static u32 net_lossy_receive(void* user, u8* data, u32 capacity) {
+    NetLossy* lossy = (NetLossy*)user;
+    net_lossy_flush(lossy);
+    return lossy->Inner.Receive(lossy->Inner.User, data, capacity);
+}
+
+NetTransport net_lossy_transport(NetLossy* lossy) {
+    NetTransport transport;
+    transport.User = lossy;
+    transport.Send = net_lossy_send;
+    transport.Receive = net_lossy_receive;
+    return transport;
+}
@@ -0,0 +1,48 @@
+#pragma once
+
+#include "core/base.h"
+
+/*
+    Unreliable datagram transport for netplay. Anything that can send and receive whole packets
+    without blocking fits behind a NetTransport: a UDP socket, or a wrapper around another
+    transport that delays and drops packets to test against a bad connection on one machine.
+*/
+
+#define NET_MAX_PACKET 512
+
+struct NetTransport {
+    void* User;
+    bool (*Send)(void* user, const u8* data, u32 size);
+    u32 (*Receive)(void* user, u8* data, u32 capacity); // Size of the packet read, 0 when none is waiting.
+};
+
+/*
+    Non-blocking UDP socket bound to localPort and connected to one peer, e.g. "127.0.0.1" to
+    play two copies over loopback. Desktop only.
+*/
+
+struct NetSocket;
+
+NetSocket* net_socket_open(u16 localPort, const char* remoteAddress, u16 remotePort);
+void net_socket_close(NetSocket* socket);
+NetTransport net_socket_transport(NetSocket* socket);
+
+/*
+    Holds back each packet sent through it by Latency plus up to Jitter seconds (so packets can
+    arrive out of order) and drops a Loss fraction of them. Time only moves when set, which lets
+    tests run a simulated clock as fast as they like.
+*/
+
+struct NetConditions {
+    f64 Latency;
+    f64 Jitter;
+    f32 Loss;
+    u32 Seed;
+};
+
+struct NetLossy;
+
+NetLossy* net_lossy_create(NetTransport inner, const NetConditions& conditions);
+void net_lossy_destroy(NetLossy* lossy);
+void net_lossy_set_time(NetLossy* lossy, f64 now);
+NetTransport net_lossy_transport(NetLossy* lossy);
@@ -3,6 +3,7 @@
 #include "core/base.h"
 
 #include <chrono>
+#include <cstdlib>
 
 namespace Utils {
     inline u32 HashPCG(u32 in) {
@@ -11,19 +12,36 @@ namespace Utils {
         return (word >> 22u) ^ word;
     }
 
+    /*
+        Reads command line argument `index` as a whole number, or keeps `fallback` when it is
+        not given. Anything that is not a positive number is refused, so a count of 0 from a
+        typo can never reach a tool's loops.
+    */
+
+    inline bool ParseCount(i32 argc, char* argv[], i32 index, u64 fallback, u64* value) {
+        if (argc <= index) {
+            *value = fallback;
+            return true;
+        }
+
+        char* end;
+        *value = strtoull(argv[index], &end, 10);
+        return end != argv[index] && *end == '\0' && argv[index][0] != '-' && *value > 0;
+    }
+
     class Clock {
         public:
             Clock() = default;
             ~Clock() = default;
 
             f64 Tick() {
-                auto next = std::chrono::high_resolution_clock::now();
+                auto next = std::chrono::steady_clock::now();
                 f64 dt = std::chrono::duration<f64, std::chrono::seconds::period>(next - m_Now).count();
                 m_Now = next;
                 return dt;
             }
 
         private:
-            std::chrono::steady_clock::time_point m_Now = std::chrono::high_resolution_clock::now();
+            std::chrono::steady_clock::time_point m_Now = std::chrono::steady_clock::now();
     };
 }
\ No newline at end of file
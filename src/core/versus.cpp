@@ -0,0 +1,135 @@
+#include "core/versus.hpp"
+
+#include "core/utils.hpp"
+#include "maths/random.hpp"
+
+static u32 s_AttackLines[5] = {
+    0, // No clear
+    0, // Single
+    1, // Double
+    2, // Triple
+    4  // Tetris
+};
+
+u32 versus_attack_lines(u32 lineCount) {
+    // Two locks can land in one tick (a soft drop lock followed by a hard drop), count those as is.
+    return lineCount <= 4 ? s_AttackLines[lineCount] : lineCount;
+}
+
+/*
+    Both players get the same pieces and the same garbage holes, so neither is luckier than the other.
+*/
+
+void versus_reset(VersusMatch& match, u32 pieceSeed, u32 garbageSeed) {
+    match = {};
+    for (u32 p = 0; p < VERSUS_PLAYER_COUNT; p++) {
+        VersusPlayer& player = match.Players[p];
+        game_sim_restart(player.Sim, pieceSeed);
+        player.GarbageSeed = garbageSeed;
+    }
+    match.Outcome = VersusOutcome::Playing;
+}
+
+static void versus_raise_garbage(VersusPlayer& player) {
+    u32 rows = player.PendingGarbage < VERSUS_MAX_GARBAGE_PER_LOCK ? player.PendingGarbage : VERSUS_MAX_GARBAGE_PER_LOCK;
+    if (rows == 0) {
+        return;
+    }
+    player.PendingGarbage -= rows;
+    player.LinesReceived += rows;
+
+    u32 hole = RandU32(player.GarbageSeed, 0, FIELD_WIDTH - 1);
+    bool overflow = field_insert_garbage(player.Sim.Field, rows, hole, SHAPE_GARBAGE_ID);
+    if (overflow) {
+        player.Sim.GameState = GameState::GameOver;
+    } else {
+        game_sim_check_top_out(player.Sim);
+    }
+}
+
+/*
+    Steps both games by one tick with one input each. Attacks are worked out against the garbage
+    pending before the tick and delivered after it, so the order the players are stepped in
+    never matters.
+*/
+
+VersusOutcome versus_step(VersusMatch& match, const GameInput* inputs) {
+    if (match.Outcome != VersusOutcome::Playing) {
+        return match.Outcome;
+    }
+
+    u32 attacks[VERSUS_PLAYER_COUNT] = {};
+    for (u32 p = 0; p < VERSUS_PLAYER_COUNT; p++) {
+        VersusPlayer& player = match.Players[p];
+
+        GameStepResult result;
+        game_sim_step(player.Sim, inputs[p], nullptr, &result);
+        if (!(result.Events & GAME_EVENT_LOCKED)) {
+            continue;
+        }
+        player.PiecesLocked += result.PiecesLocked;
+
+        u32 attack = versus_attack_lines(result.LinesCleared);
+        u32 cancelled = attack < player.PendingGarbage ? attack : player.PendingGarbage;
+        player.PendingGarbage -= cancelled;
+        attacks[p] = attack - cancelled;
+
+        if (result.LinesCleared == 0 && player.Sim.GameState == GameState::Playing) {
+            versus_raise_garbage(player);
+        }
+    }
+
+    for (u32 p = 0; p < VERSUS_PLAYER_COUNT; p++) {
+        VersusPlayer& opponent = match.Players[(p + 1) % VERSUS_PLAYER_COUNT];
+        opponent.PendingGarbage += attacks[p];
+        match.Players[p].LinesSent += attacks[p];
+    }
+
+    match.Tick++;
+
+    bool over[VERSUS_PLAYER_COUNT];
+    u32 overCount = 0;
+    for (u32 p = 0; p < VERSUS_PLAYER_COUNT; p++) {
+        over[p] = match.Players[p].Sim.GameState != GameState::Playing;
+        overCount += over[p];
+    }
+
+    if (overCount == VERSUS_PLAYER_COUNT) {
+        match.Outcome = VersusOutcome::Draw;
+    } else if (overCount > 0) {
+        match.Outcome = VersusOutcome::Won;
+        match.Winner = over[0] ? 1 : 0;
+    }
+    return match.Outcome;
+}
+
+/*
+    Hash of everything that decides how a match plays on, for checking two copies stayed in
+    sync. Works field by field rather than over the raw bytes so struct padding never counts.
+*/
+
+static void versus_hash(u32& hash, u32 value) {
+    hash = Utils::HashPCG(hash ^ value);
+}
+
+u32 versus_checksum(const VersusMatch& match) {
+    u32 hash = match.Tick;
+    for (u32 p = 0; p < VERSUS_PLAYER_COUNT; p++) {
+        const VersusPlayer& player = match.Players[p];
+        const GameSim& sim = player.Sim;
+        for (u32 i = 0; i < FIELD_SIZE; i++) {
+            versus_hash(hash, sim.Field[i]);
+        }
+        versus_hash(hash, (u32)sim.GameState);
+        versus_hash(hash, (u32)sim.PlayerX);
+        versus_hash(hash, (u32)sim.PlayerY);
+        versus_hash(hash, sim.CurrentShape.ID | (shape_get_rotation(sim.CurrentShape) << 8));
+        versus_hash(hash, sim.NextShape.ID | (shape_get_rotation(sim.NextShape) << 8));
+        versus_hash(hash, sim.CanSwap);
+        versus_hash(hash, sim.Score);
+        versus_hash(hash, sim.Seed);
+        versus_hash(hash, player.GarbageSeed);
+        versus_hash(hash, player.PendingGarbage);
+    }
+    return hash;
+}
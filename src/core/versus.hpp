@@ -0,0 +1,58 @@
+#pragma once
+
+#include "core/base.h"
+#include "core/game_sim.hpp"
+
+#include <type_traits>
+
+/*
+    Two player versus. Both games run the regular rules (game_sim.hpp) in lockstep at a fixed
+    tick, from the same piece sequence, and lines cleared send garbage rows to the opponent.
+    A match is plain data, so it can be copied to snapshot it and stepped from any copy, and
+    two machines fed the same inputs stay in sync.
+
+    Garbage rules, per piece lock:
+        - Clearing 1, 2, 3 or 4 lines attacks with 0, 1, 2 or 4 rows (see versus_attack_lines).
+        - An attack first cancels the attacker's own pending garbage, the rest is queued on the
+          opponent and lands no sooner than their next lock.
+        - A lock that clears nothing raises up to VERSUS_MAX_GARBAGE_PER_LOCK pending rows, each
+          batch sharing one hole column drawn from the receiver's garbage seed.
+        - A player tops out when garbage pushes cells off the top or into the falling piece.
+*/
+
+#define VERSUS_PLAYER_COUNT 2
+
+#define VERSUS_TICK_RATE GAME_TICK_RATE
+#define VERSUS_TICK_TIME GAME_TICK_TIME
+
+#define VERSUS_MAX_GARBAGE_PER_LOCK 8
+
+enum class VersusOutcome {
+    Playing,
+    Won,    // See VersusMatch::Winner.
+    Draw,   // Both players topped out on the same tick.
+};
+
+struct VersusPlayer {
+    GameSim Sim;
+    u32 GarbageSeed;    // Hole columns of the garbage this player receives.
+    u32 PendingGarbage; // Rows queued to rise on this player's next lock without a clear.
+    u32 LinesSent;
+    u32 LinesReceived;
+    u32 PiecesLocked;
+};
+
+struct VersusMatch {
+    VersusPlayer Players[VERSUS_PLAYER_COUNT];
+    u32 Tick;
+    VersusOutcome Outcome;
+    u32 Winner;
+};
+
+STATIC_ASSERT(std::is_trivially_copyable<VersusMatch>::value, "VersusMatch must stay plain data to be snapshotted.");
+
+u32 versus_attack_lines(u32 lineCount);
+
+void versus_reset(VersusMatch& match, u32 pieceSeed, u32 garbageSeed);
+VersusOutcome versus_step(VersusMatch& match, const GameInput* inputs);
+u32 versus_checksum(const VersusMatch& match);
@@ -0,0 +1,159 @@
+#include "env/tetris_vec_env.h"
+
+#include "core/base.h"
+#include "core/sim.hpp"
+#include "core/jobs.hpp"
+#include "maths/random.hpp"
+
+#define VEC_ENV_COLUMNS (SIM_MAX_X - SIM_MIN_X + 1)
+
+// Games handed to a worker at a time, large enough that scheduling cost disappears.
+#define VEC_ENV_BLOCK_SIZE 64
+
+STATIC_ASSERT(TETRIS_VEC_ENV_WIDTH == FIELD_WIDTH, "Vec env width out of sync with the field.");
+STATIC_ASSERT(TETRIS_VEC_ENV_HEIGHT == FIELD_HEIGHT, "Vec env height out of sync with the field.");
+STATIC_ASSERT(TETRIS_VEC_ENV_NUM_ACTIONS == 2 * SHAPE_ROTATION_COUNT * VEC_ENV_COLUMNS, "Vec env action count out of sync.");
+STATIC_ASSERT(TETRIS_VEC_ENV_NUM_ACTIONS == SIM_MAX_PLACEMENTS, "Vec env action count out of sync.");
+
+/*
+    Per game state. The legal placements are cached by action index whenever the state changes,
+    so stepping is a table lookup.
+*/
+
+struct VecEnvGame {
+    SimState State;
+    u32 EpisodeSeed;
+    Placement Actions[TETRIS_VEC_ENV_NUM_ACTIONS];
+    u8 IsLegal[TETRIS_VEC_ENV_NUM_ACTIONS];
+};
+
+struct tetris_vec_env {
+    u32 NumEnvs;
+    u32 MaxPieces;
+    JobPool* Jobs;
+    VecEnvGame* Games;
+
+    // Set for the duration of a reset or step so the jobs can see them.
+    const i32* Actions;
+    const tetris_vec_env_buffers* Buffers;
+};
+
+static u32 vec_env_action_index(const Placement& placement) {
+    return placement.Swap * (SHAPE_ROTATION_COUNT * VEC_ENV_COLUMNS) + placement.Rotation * VEC_ENV_COLUMNS + (placement.X - SIM_MIN_X);
+}
+
+/*
+    Rebuilds the legal placement table for the current piece. Called whenever the state changes,
+    so IsLegal and Actions always describe the game a step will be applied to.
+*/
+
+static void vec_env_update_actions(VecEnvGame& game) {
+    Placement placements[SIM_MAX_PLACEMENTS];
+    u32 count = sim_get_placements(game.State, placements, true);
+    memset(game.IsLegal, 0, sizeof(game.IsLegal));
+    for (u32 i = 0; i < count; i++) {
+        u32 action = vec_env_action_index(placements[i]);
+        game.Actions[action] = placements[i];
+        game.IsLegal[action] = 1;
+    }
+}
+
+static void vec_env_new_episode(VecEnvGame& game) {
+    sim_reset(game.State, RandU32(game.EpisodeSeed));
+    vec_env_update_actions(game);
+}
+
+static void vec_env_write_observation(const VecEnvGame& game, const tetris_vec_env_buffers* buffers, u32 index) {
+    const SimState& state = game.State;
+
+    field_to_rows(state.Field, buffers->boards + index * FIELD_HEIGHT);
+
+    buffers->current_piece[index] = (u8)state.CurrentID;
+    buffers->next_piece[index] = (u8)state.NextID;
+
+    memcpy(buffers->action_mask + index * TETRIS_VEC_ENV_NUM_ACTIONS, game.IsLegal, sizeof(game.IsLegal));
+}
+
+static void vec_env_reset_job(void* userData, u32 block, u32 /* threadIndex */) {
+    tetris_vec_env* env = (tetris_vec_env*)userData;
+    u32 end = (block + 1) * VEC_ENV_BLOCK_SIZE;
+    end = end < env->NumEnvs ? end : env->NumEnvs;
+    for (u32 i = block * VEC_ENV_BLOCK_SIZE; i < end; i++) {
+        vec_env_new_episode(env->Games[i]);
+        vec_env_write_observation(env->Games[i], env->Buffers, i);
+        env->Buffers->score_deltas[i] = 0;
+        env->Buffers->dones[i] = 0;
+    }
+}
+
+static void vec_env_step_job(void* userData, u32 block, u32 /* threadIndex */) {
+    tetris_vec_env* env = (tetris_vec_env*)userData;
+    u32 end = (block + 1) * VEC_ENV_BLOCK_SIZE;
+    end = end < env->NumEnvs ? end : env->NumEnvs;
+    for (u32 i = block * VEC_ENV_BLOCK_SIZE; i < end; i++) {
+        VecEnvGame& game = env->Games[i];
+        i32 action = env->Actions[i];
+
+        u32 scoreBefore = game.State.Score;
+        bool isDone = true;
+        if (action >= 0 && action < TETRIS_VEC_ENV_NUM_ACTIONS && game.IsLegal[action]) {
+            sim_apply_placement(game.State, game.Actions[action]);
+            isDone = game.State.IsOver || (env->MaxPieces && game.State.Pieces >= env->MaxPieces);
+        }
+
+        env->Buffers->score_deltas[i] = (i32)(game.State.Score - scoreBefore);
+        env->Buffers->dones[i] = isDone;
+
+        if (isDone) {
+            vec_env_new_episode(game);
+        } else {
+            vec_env_update_actions(game);
+        }
+        vec_env_write_observation(game, env->Buffers, i);
+    }
+}
+
+static u32 vec_env_block_count(const tetris_vec_env* env) {
+    return (env->NumEnvs + VEC_ENV_BLOCK_SIZE - 1) / VEC_ENV_BLOCK_SIZE;
+}
+
+tetris_vec_env* tetris_vec_env_create(uint32_t num_envs, uint32_t seed, uint32_t max_pieces, uint32_t num_threads) {
+    tetris_vec_env* env = new tetris_vec_env();
+    env->NumEnvs = num_envs;
+    env->MaxPieces = max_pieces;
+    env->Jobs = jobs_create(num_threads);
+    env->Games = new VecEnvGame[num_envs]();
+    env->Actions = nullptr;
+    env->Buffers = nullptr;
+
+    // Every game draws its episodes from its own stream, so results do not depend on threading.
+    for (u32 i = 0; i < num_envs; i++) {
+        env->Games[i].EpisodeSeed = Utils::HashPCG(seed ^ Utils::HashPCG(i + 1));
+        vec_env_new_episode(env->Games[i]);
+    }
+    return env;
+}
+
+void tetris_vec_env_destroy(tetris_vec_env* env) {
+    jobs_destroy(env->Jobs);
+    delete[] env->Games;
+    delete env;
+}
+
+uint32_t tetris_vec_env_num_envs(const tetris_vec_env* env) {
+    return env->NumEnvs;
+}
+
+void tetris_vec_env_reset(tetris_vec_env* env, const tetris_vec_env_buffers* buffers) {
+    env->Buffers = buffers;
+    jobs_parallel_for(env->Jobs, vec_env_block_count(env), vec_env_reset_job, env);
+    env->Buffers = nullptr;
+}
+
+void tetris_vec_env_step(tetris_vec_env* env, const int32_t* actions, const tetris_vec_env_buffers* buffers) {
+    env->Actions = actions;
+    env->Buffers = buffers;
+    jobs_parallel_for(env->Jobs, vec_env_block_count(env), vec_env_step_job, env);
+    env->Actions = nullptr;
+    env->Buffers = nullptr;
+}
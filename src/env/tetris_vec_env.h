@@ -0,0 +1,51 @@
+#pragma once
+
+/*
+    C ABI for stepping many independent games in lockstep, for reinforcement learning. All
+    observations are written into caller-owned, contiguous structure-of-arrays buffers, so a
+    step performs no allocation and the buffers can be wrapped directly as tensors.
+
+    Actions index a fixed table of placements:
+
+        action = swap * (4 * 13) + rotation * 13 + (x + 3)
+
+    where x is the column of the left edge of the piece's 4x4 box (-3 to 9). Illegal actions
+    (masked out in action_mask) end the episode. Finished games reset automatically: the step
+    that ends a game reports its done flag and final score delta, and the observation written
+    alongside it is already the first observation of the next game.
+*/
+
+#include <stdint.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#define TETRIS_VEC_ENV_WIDTH 10
+#define TETRIS_VEC_ENV_HEIGHT 18
+#define TETRIS_VEC_ENV_NUM_ACTIONS 104
+
+typedef struct tetris_vec_env tetris_vec_env;
+
+typedef struct tetris_vec_env_buffers {
+    uint16_t* boards;       /* [num_envs][HEIGHT] row bitmasks, bit c is column c, row 0 is the bottom. */
+    uint8_t* current_piece; /* [num_envs] piece IDs 1 to 7. */
+    uint8_t* next_piece;    /* [num_envs] */
+    uint8_t* action_mask;   /* [num_envs][NUM_ACTIONS] 1 where the action is legal. */
+    int32_t* score_deltas;  /* [num_envs] score gained by the last step. */
+    uint8_t* dones;         /* [num_envs] 1 where the last step ended the game. */
+} tetris_vec_env_buffers;
+
+/* max_pieces of zero plays every game until it tops out. num_threads of zero uses every core. */
+tetris_vec_env* tetris_vec_env_create(uint32_t num_envs, uint32_t seed, uint32_t max_pieces, uint32_t num_threads);
+void tetris_vec_env_destroy(tetris_vec_env* env);
+
+uint32_t tetris_vec_env_num_envs(const tetris_vec_env* env);
+
+/* Every game is already in its first episode after create; reset restarts them and writes their observations. */
+void tetris_vec_env_reset(tetris_vec_env* env, const tetris_vec_env_buffers* buffers);
+void tetris_vec_env_step(tetris_vec_env* env, const int32_t* actions, const tetris_vec_env_buffers* buffers);
+
+#ifdef __cplusplus
+}
+#endif
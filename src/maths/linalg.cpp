@@ -1,6 +1,8 @@
 #include "maths/numerics.hpp"
 #include "maths/linalg.hpp"
 
+#include <cmath>
+
 f32 SqrMagnitude(const Vec2& v) {
     return Dot(v, v);
 }
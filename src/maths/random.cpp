@@ -22,6 +22,10 @@ u32 RandU32(u32 min, u32 max) {
     return RandU32(s_Seed, min, max);
 }
 
+f32 RandNormal() {
+    return RandNormal(s_Seed);
+}
+
 Vec2 RandVec2() {
     return RandVec2(s_Seed);
 }
@@ -5,10 +5,13 @@
 #include "maths/numerics.hpp"
 #include "maths/linalg.hpp"
 
+#include <cmath>
+
 f32 RandFloat();
 f32 RandFloat(f32 min, f32 max);
 u32 RandU32();
 u32 RandU32(u32 min, u32 max);
+f32 RandNormal();
 Vec2 RandVec2();
 Vec3 RandVec3();
 Mat2x2 RandMat2();
@@ -34,6 +37,17 @@ inline u32 RandU32(u32& seed, u32 min, u32 max) {
     return min + (RandU32(seed) % (max - min + 1));
 }
 
+/*
+    Standard normal sample via Box-Muller. The first uniform is kept away from zero so the log is finite.
+*/
+
+inline f32 RandNormal(u32& seed) {
+    f32 u1 = RandFloat(seed);
+    f32 u2 = RandFloat(seed);
+    u1 = u1 < 1e-7f ? 1e-7f : u1;
+    return sqrtf(-2.0f * logf(u1)) * cosf((f32)TAU * u2);
+}
+
 inline Vec2 RandVec2(u32& seed) {
     return { RandFloat(seed), RandFloat(seed) };
 }
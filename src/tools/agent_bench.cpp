@@ -0,0 +1,115 @@
+#include "core/base.h"
+#include "core/utils.hpp"
+#include "core/sim.hpp"
+#include "core/jobs.hpp"
+#include "bots/evaluator.hpp"
+#include "bots/mcts.hpp"
+#include "bots/network.hpp"
+
+/*
+    Plays the same seeded games with the greedy heuristic search and with MCTS, and reports how
+    each did alongside the CPU time it took, so the two can be compared at equal budgets. Given a
+    network file, both agents score boards with it instead of the heuristic weights.
+
+    usage: agent_bench [games] [max pieces] [rollouts per move] [threads] [network]
+*/
+
+struct BenchResult {
+    u64 Score;
+    u64 Lines;
+    u64 Pieces;
+    f64 Seconds;
+};
+
+static void bench_print(const char* name, const BenchResult& result, u32 games) {
+    printf(
+        "%-8s avg score %10.1f  avg lines %7.1f  avg pieces %7.1f  %8.3f ms/move\n",
+        name,
+        (f64)result.Score / games,
+        (f64)result.Lines / games,
+        (f64)result.Pieces / games,
+        result.Pieces ? 1000.0 * result.Seconds / (f64)result.Pieces : 0.0
+    );
+}
+
+int main(int argc, char* argv[]) {
+    u32 games = argc > 1 ? (u32)atoi(argv[1]) : 4;
+    u32 maxPieces = argc > 2 ? (u32)atoi(argv[2]) : 500;
+    u32 rollouts = argc > 3 ? (u32)atoi(argv[3]) : 1024;
+    u32 threads = argc > 4 ? (u32)atoi(argv[4]) : 0;
+
+    Network* network = nullptr;
+    if (argc > 5) {
+        network = network_load(argv[5]);
+        if (!network) {
+            return 1;
+        }
+    }
+
+    JobPool* jobs = jobs_create(threads);
+
+    MCTSConfig config;
+    config.Rollouts = rollouts;
+    config.Net = network;
+    config.Seed = 0x5eed;
+    MCTSAgent* mcts = mcts_create(config, jobs);
+
+    EvalWeights weights = evaluator_default_weights();
+    BenchResult greedyResult = {};
+    BenchResult mctsResult = {};
+    Utils::Clock timer;
+
+    for (u32 game = 0; game < games; game++) {
+        u32 seed = Utils::HashPCG(game + 1);
+
+        SimState state;
+        sim_reset(state, seed);
+        timer.Tick();
+        while (!state.IsOver && state.Pieces < maxPieces) {
+            Placement placement;
+            bool picked = network
+                ? network_pick_placement(network, state, true, &placement)
+                : evaluator_pick_placement(state, weights, true, &placement);
+            if (!picked) {
+                break;
+            }
+            sim_apply_placement(state, placement);
+        }
+        greedyResult.Seconds += timer.Tick();
+        greedyResult.Score += state.Score;
+        greedyResult.Lines += state.Lines;
+        greedyResult.Pieces += state.Pieces;
+
+        sim_reset(state, seed);
+        timer.Tick();
+        while (!state.IsOver && state.Pieces < maxPieces) {
+            Placement placement;
+            if (!mcts_search(mcts, state, &placement)) {
+                break;
+            }
+            sim_apply_placement(state, placement);
+        }
+        mctsResult.Seconds += timer.Tick();
+        mctsResult.Score += state.Score;
+        mctsResult.Lines += state.Lines;
+        mctsResult.Pieces += state.Pieces;
+    }
+
+    MCTSStats stats = mcts_get_stats(mcts);
+    printf("%u games, %u pieces max, %u rollouts per move, %u threads\n", games, maxPieces, rollouts, jobs_thread_count(jobs));
+    bench_print("greedy", greedyResult, games);
+    bench_print("mcts", mctsResult, games);
+    printf(
+        "mcts rollouts %llu (%.0f rollouts/s, %.0f pieces/s)\n",
+        stats.Rollouts,
+        stats.RolloutSeconds > 0.0 ? (f64)stats.Rollouts / stats.RolloutSeconds : 0.0,
+        stats.RolloutSeconds > 0.0 ? (f64)stats.RolloutPieces / stats.RolloutSeconds : 0.0
+    );
+
+    mcts_destroy(mcts);
+    jobs_destroy(jobs);
+    if (network) {
+        network_destroy(network);
+    }
+    return 0;
+}
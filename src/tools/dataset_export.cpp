@@ -0,0 +1,114 @@
+#include "core/base.h"
+#include "core/utils.hpp"
+#include "core/sim.hpp"
+#include "core/jobs.hpp"
+#include "bots/evaluator.hpp"
+#include "bots/dataset.hpp"
+#include "maths/random.hpp"
+
+#include <vector>
+
+/*
+    Plays games with the greedy evaluator (optionally epsilon-greedy, for more varied boards)
+    and writes every placement to a dataset, one shard file per job so no writes are shared.
+
+    usage: dataset_export [output prefix] [records per shard] [shards] [epsilon] [max pieces] [threads] [weights]
+*/
+
+struct ExportJob {
+    const char* Prefix;
+    u64 RecordsPerShard;
+    f32 Epsilon;
+    u32 MaxPieces;
+    EvalWeights Weights;
+    std::vector<u64> Games;
+};
+
+static void export_shard(void* userData, u32 shard, u32 /* threadIndex */) {
+    ExportJob* job = (ExportJob*)userData;
+
+    char path[512];
+    snprintf(path, sizeof(path), "%s-%03u.bin", job->Prefix, shard);
+    DatasetWriter* writer = dataset_writer_open(path);
+    if (!writer) {
+        return;
+    }
+
+    u32 seed = Utils::HashPCG(shard + 1);
+    std::vector<DatasetRecord> records(job->MaxPieces);
+    Placement placements[SIM_MAX_PLACEMENTS];
+
+    while (dataset_writer_count(writer) < job->RecordsPerShard) {
+        SimState state;
+        sim_reset(state, RandU32(seed));
+
+        u32 count = 0;
+        while (!state.IsOver && count < job->MaxPieces) {
+            Placement placement;
+            if (RandFloat(seed) < job->Epsilon) {
+                u32 available = sim_get_placements(state, placements, true);
+                placement = placements[RandU32(seed, 0, available - 1)];
+            } else if (!evaluator_pick_placement(state, job->Weights, true, &placement)) {
+                break;
+            }
+
+            DatasetRecord& record = records[count++];
+            dataset_record_init(record, state, placement);
+            record.LinesCleared = (u8)sim_apply_placement(state, placement);
+        }
+
+        dataset_finish_game(records.data(), count, state.IsOver);
+
+        u64 remaining = job->RecordsPerShard - dataset_writer_count(writer);
+        dataset_writer_append(writer, records.data(), (u32)(count < remaining ? count : remaining));
+        job->Games[shard]++;
+    }
+
+    dataset_writer_close(writer);
+}
+
+int main(int argc, char* argv[]) {
+    ExportJob job;
+    job.Prefix = argc > 1 ? argv[1] : "dataset";
+    job.Epsilon = argc > 4 ? (f32)atof(argv[4]) : 0.05f;
+
+    u64 shards, maxPieces, threads;
+    if (!Utils::ParseCount(argc, argv, 2, 1000000, &job.RecordsPerShard)
+        || !Utils::ParseCount(argc, argv, 3, 8, &shards)
+        || !Utils::ParseCount(argc, argv, 5, 2000, &maxPieces)
+        || !Utils::ParseCount(argc, argv, 6, 0, &threads)
+        || shards > 0xffffffff || maxPieces > 0xffffffff || threads > 0xffffffff) {
+        printf("usage: dataset_export [output prefix] [records per shard] [shards] [epsilon] [max pieces] [threads] [weights]\n");
+        printf("records, shards, pieces and threads must be positive numbers; threads defaults to one per core\n");
+        return 1;
+    }
+    job.MaxPieces = (u32)maxPieces;
+
+    job.Weights = evaluator_default_weights();
+    if (argc > 7 && !evaluator_load_weights(argv[7], &job.Weights)) {
+        return 1;
+    }
+    job.Games.assign(shards, 0);
+
+    JobPool* jobs = jobs_create((u32)threads);
+    Utils::Clock clock;
+    jobs_parallel_for(jobs, (u32)shards, export_shard, &job);
+    f64 seconds = clock.Tick();
+
+    u64 games = 0;
+    for (u64 count : job.Games) {
+        games += count;
+    }
+    u64 records = job.RecordsPerShard * shards;
+    printf(
+        "%llu records from %llu games in %.2fs (%.0f records/s, %.1f MB)\n",
+        records,
+        games,
+        seconds,
+        (f64)records / seconds,
+        (f64)(records * sizeof(DatasetRecord)) / (1024.0 * 1024.0)
+    );
+
+    jobs_destroy(jobs);
+    return 0;
+}
@@ -0,0 +1,79 @@
+#include "core/base.h"
+#include "core/sim.hpp"
+#include "core/replay.hpp"
+#include "core/finesse.hpp"
+
+/*
+    Reports finesse faults for recorded games (the game writes the last one to last_replay.ttr),
+    or with --table prints the shortest inputs to every column for pieces spawning unrotated.
+
+    usage: finesse_report replay... | finesse_report --table
+*/
+
+static void print_table() {
+    for (u32 id = 1; id < SHAPE_COUNT; id++) {
+        for (u32 r = 0; r < SHAPE_ROTATION_COUNT; r++) {
+            for (i32 x = SIM_MIN_X; x <= SIM_MAX_X; x++) {
+                const FinessePath& path = finesse_get_path(id, 0, r, x);
+                if (path.Count == FINESSE_UNREACHABLE) {
+                    continue;
+                }
+                printf("piece %u rotation %u x %3d  %u:", id, r, x, path.Count);
+                for (u32 i = 0; i < path.Count; i++) {
+                    printf(" %s", finesse_input_name(path.Inputs[i]));
+                }
+                printf("\n");
+            }
+        }
+    }
+}
+
+int main(int argc, char* argv[]) {
+    if (argc < 2) {
+        printf("usage: finesse_report replay... | finesse_report --table\n");
+        return 1;
+    }
+    if (strcmp(argv[1], "--table") == 0) {
+        print_table();
+        return 0;
+    }
+
+    Replay replay = {};
+    FinesseReport total = {};
+    for (i32 i = 1; i < argc; i++) {
+        if (!replay_load(argv[i], &replay)) {
+            continue;
+        }
+        FinesseReport report = finesse_analyse(replay.Pieces, replay.Count);
+        printf(
+            "%s: score %u, %u pieces, %u judged, %u faults (%.1f%%), %u presses for %u optimal\n",
+            argv[i],
+            replay.Score,
+            report.Pieces,
+            report.Judged,
+            report.Faults,
+            report.Judged ? 100.0 * report.Faults / report.Judged : 0.0,
+            report.Presses,
+            report.OptimalPresses
+        );
+        total.Pieces += report.Pieces;
+        total.Judged += report.Judged;
+        total.Faults += report.Faults;
+        total.Presses += report.Presses;
+        total.OptimalPresses += report.OptimalPresses;
+    }
+
+    if (argc > 2) {
+        printf(
+            "total: %u pieces, %u judged, %u faults (%.1f%%), %u presses for %u optimal\n",
+            total.Pieces,
+            total.Judged,
+            total.Faults,
+            total.Judged ? 100.0 * total.Faults / total.Judged : 0.0,
+            total.Presses,
+            total.OptimalPresses
+        );
+    }
+    replay_free(&replay);
+    return 0;
+}
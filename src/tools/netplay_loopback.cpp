@@ -0,0 +1,146 @@
+#include "core/base.h"
+#include "core/utils.hpp"
+#include "core/netplay.hpp"
+#include "bots/driver.hpp"
+#include "bots/evaluator.hpp"
+
+/*
+    Plays a versus match between two netplay sessions in one process, talking over real UDP
+    sockets on loopback with latency, jitter and loss injected on both sides. The clock is
+    simulated at 60 frames a second but runs as fast as it can. At the end both sessions must
+    agree with each other and with the match replayed offline from the inputs each side
+    actually used, and the rollback cost is reported.
+
+    usage: netplay_loopback [ticks] [latency ms] [jitter ms] [loss %] [base port]
+*/
+
+struct Peer {
+    NetSocket* Socket;
+    NetLossy* Lossy;
+    NetplaySession* Session;
+    InputDriver Driver;
+    GameInput Pending;
+    bool HasPending;
+    GameInput* Used; // Local input of every tick, for the offline replay.
+};
+
+static void peer_frame(Peer& peer, u32 player, const EvalWeights& weights) {
+    if (!peer.HasPending) {
+        const GameSim& sim = netplay_get_match(peer.Session).Players[player].Sim;
+        if (!peer.Driver.Active) {
+            Placement placement;
+            if (evaluator_pick_placement(driver_sim_state(sim), weights, sim.CanSwap, &placement)) {
+                driver_start(peer.Driver, placement);
+            }
+        }
+        peer.Pending = driver_next_input(peer.Driver, sim);
+        peer.HasPending = true;
+    }
+
+    u32 tick = netplay_current_tick(peer.Session);
+    if (netplay_advance(peer.Session, peer.Pending)) {
+        peer.Used[tick] = peer.Pending;
+        peer.HasPending = false;
+    }
+}
+
+int main(int argc, char* argv[]) {
+    u32 ticks = argc > 1 ? (u32)atoi(argv[1]) : 60 * 60;
+    f64 latency = (argc > 2 ? atof(argv[2]) : 50.0) / 1000.0;
+    f64 jitter = (argc > 3 ? atof(argv[3]) : 20.0) / 1000.0;
+    f32 loss = (f32)(argc > 4 ? atof(argv[4]) : 5.0) / 100.0f;
+    u16 basePort = argc > 5 ? (u16)atoi(argv[5]) : 47810;
+
+    const u32 pieceSeed = 0x5eed;
+    const u32 garbageSeed = 0x9a7ba9e;
+    EvalWeights weights = evaluator_default_weights();
+
+    Peer peers[VERSUS_PLAYER_COUNT] = {};
+    for (u32 p = 0; p < VERSUS_PLAYER_COUNT; p++) {
+        Peer& peer = peers[p];
+        peer.Socket = net_socket_open(basePort + p, "127.0.0.1", basePort + (1 - p));
+        if (!peer.Socket) {
+            return 1;
+        }
+
+        NetConditions conditions = { latency, jitter, loss, Utils::HashPCG(p + 1) };
+        peer.Lossy = net_lossy_create(net_socket_transport(peer.Socket), conditions);
+        peer.Session = netplay_create(net_lossy_transport(peer.Lossy), p, pieceSeed, garbageSeed);
+        peer.Used = new GameInput[ticks];
+    }
+
+    // Play every tick, then keep polling until each side has the other's last input.
+    f64 now = 0.0;
+    u32 frames = 0;
+    Utils::Clock timer;
+    auto finished = [&]() {
+        for (u32 p = 0; p < VERSUS_PLAYER_COUNT; p++) {
+            if (netplay_confirmed_tick(peers[p].Session) < ticks) {
+                return false;
+            }
+        }
+        return true;
+    };
+
+    while (!finished()) {
+        now += 1.0 / 60.0;
+        frames++;
+        for (u32 p = 0; p < VERSUS_PLAYER_COUNT; p++) {
+            net_lossy_set_time(peers[p].Lossy, now);
+            if (netplay_current_tick(peers[p].Session) < ticks) {
+                peer_frame(peers[p], p, weights);
+            } else {
+                netplay_poll(peers[p].Session);
+            }
+        }
+    }
+    f64 seconds = timer.Tick();
+
+    VersusMatch offline;
+    versus_reset(offline, pieceSeed, garbageSeed);
+    for (u32 tick = 0; tick < ticks; tick++) {
+        GameInput inputs[VERSUS_PLAYER_COUNT] = { peers[0].Used[tick], peers[1].Used[tick] };
+        versus_step(offline, inputs);
+    }
+
+    u32 expected = versus_checksum(offline);
+    bool inSync = true;
+    printf("%u ticks in %u frames, %.0f ms latency, %.0f ms jitter, %.1f%% loss\n", ticks, frames, latency * 1000.0, jitter * 1000.0, loss * 100.0);
+    for (u32 p = 0; p < VERSUS_PLAYER_COUNT; p++) {
+        u32 checksum = versus_checksum(netplay_get_match(peers[p].Session));
+        NetplayStats stats = netplay_get_stats(peers[p].Session);
+        inSync &= checksum == expected;
+        printf(
+            "player %u: checksum %08x  stalls %llu  rollbacks %llu  resimulated %llu ticks (max %u)  rollback avg %.1f us, max %.1f us  packets %llu sent %llu received %llu rejected\n",
+            p,
+            checksum,
+            stats.Stalls,
+            stats.Rollbacks,
+            stats.ResimulatedTicks,
+            stats.MaxRollback,
+            stats.Rollbacks ? 1e6 * stats.RollbackSeconds / (f64)stats.Rollbacks : 0.0,
+            1e6 * stats.MaxRollbackSeconds,
+            stats.PacketsSent,
+            stats.PacketsReceived,
+            stats.PacketsRejected
+        );
+    }
+
+    const VersusMatch& match = netplay_get_match(peers[0].Session);
+    printf(
+        "offline checksum %08x: %s  scores %u / %u  (%.3f s)\n",
+        expected,
+        inSync ? "in sync" : "DESYNC",
+        match.Players[0].Sim.Score,
+        match.Players[1].Sim.Score,
+        seconds
+    );
+
+    for (u32 p = 0; p < VERSUS_PLAYER_COUNT; p++) {
+        netplay_destroy(peers[p].Session);
+        net_lossy_destroy(peers[p].Lossy);
+        net_socket_close(peers[p].Socket);
+        delete[] peers[p].Used;
+    }
+    return inSync ? 0 : 1;
+}
@@ -0,0 +1,92 @@
+#include "core/base.h"
+#include "core/utils.hpp"
+#include "core/sim.hpp"
+#include "bots/evaluator.hpp"
+#include "bots/network.hpp"
+
+/*
+    Measures batched inference throughput of the board network with every kernel this CPU
+    supports, and checks they all agree with the scalar one. Without a network file a random
+    one of a typical shape is used.
+
+    usage: network_bench [batches] [network]
+*/
+
+#define BENCH_BATCH NETWORK_MAX_BATCH
+
+int main(int argc, char* argv[]) {
+    u32 batches = argc > 1 ? (u32)atoi(argv[1]) : 2000;
+
+    Network* network = nullptr;
+    if (argc > 2) {
+        network = network_load(argv[2]);
+    } else {
+        u32 widths[] = { NETWORK_INPUT_SIZE, 256, 64, 1 };
+        network = network_create_random(widths, sizeof(widths) / sizeof(widths[0]), 0x5eed);
+    }
+    if (!network) {
+        return 1;
+    }
+
+    // A batch of real candidate boards from the middle of a game.
+    SimState state;
+    sim_reset(state, 7);
+    EvalWeights weights = evaluator_default_weights();
+    for (u32 i = 0; i < 40 && !state.IsOver; i++) {
+        Placement placement;
+        if (!evaluator_pick_placement(state, weights, false, &placement)) {
+            break;
+        }
+        sim_apply_placement(state, placement);
+    }
+
+    Placement placements[SIM_MAX_PLACEMENTS];
+    u32 count = sim_get_placements(state, placements, true);
+    u16 rows[FIELD_HEIGHT];
+    u16 preview[FIELD_HEIGHT];
+    field_to_rows(state.Field, rows);
+
+    u32 stride = network_input_stride(network);
+    u8* inputs = new u8[BENCH_BATCH * stride];
+    for (u32 i = 0; i < BENCH_BATCH; i++) {
+        const Placement& placement = placements[i % count];
+        u32 lines = sim_preview_placement(state, rows, placement, preview);
+        network_encode_board(network, preview, lines, &inputs[i * stride]);
+    }
+
+    f32 reference[BENCH_BATCH];
+    network_use_kernel(network, NetworkKernel::Scalar);
+    network_forward(network, inputs, BENCH_BATCH, reference);
+
+    NetworkKernel kernels[] = { NetworkKernel::Scalar, NetworkKernel::AVX2, NetworkKernel::WasmSIMD };
+    Utils::Clock timer;
+    for (u32 k = 0; k < sizeof(kernels) / sizeof(kernels[0]); k++) {
+        if (!network_use_kernel(network, kernels[k])) {
+            continue;
+        }
+
+        f32 outputs[BENCH_BATCH];
+        timer.Tick();
+        for (u32 b = 0; b < batches; b++) {
+            network_forward(network, inputs, BENCH_BATCH, outputs);
+        }
+        f64 seconds = timer.Tick();
+
+        u32 mismatches = 0;
+        for (u32 i = 0; i < BENCH_BATCH; i++) {
+            mismatches += outputs[i] != reference[i];
+        }
+        printf(
+            "%-10s %10.0f boards/s  %7.3f us/batch of %u  %u mismatches\n",
+            network_kernel_name(kernels[k]),
+            (f64)batches * BENCH_BATCH / seconds,
+            1000000.0 * seconds / batches,
+            BENCH_BATCH,
+            mismatches
+        );
+    }
+
+    delete[] inputs;
+    network_destroy(network);
+    return 0;
+}
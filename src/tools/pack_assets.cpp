@@ -0,0 +1,135 @@
+#include "core/base.h"
+#include "core/archive.hpp"
+
+#include <algorithm>
+
+/*
+    Packs assets into a single archive (see archive.hpp), run by the build before the game is
+    linked. Names are stored relative to the assets directory, as the game looks them up. A
+    file that is missing is left out with a warning, the game then goes without it as it would
+    without the loose file.
+
+    usage: pack-assets <archive> <assets directory> <file>...
+*/
+
+struct PackFile {
+    char Name[ARCHIVE_NAME_LENGTH];
+    u8* Data;
+    u32 Size;
+};
+
+static bool read_file(const char* path, PackFile* file) {
+    FILE* handle = fopen(path, "rb");
+    if (!handle) {
+        return false;
+    }
+
+    fseek(handle, 0, SEEK_END);
+    i64 size = ftell(handle);
+    fseek(handle, 0, SEEK_SET);
+
+    file->Size = (u32)size;
+    file->Data = new u8[size > 0 ? size : 1];
+    bool ok = size >= 0 && fread(file->Data, 1, (size_t)size, handle) == (size_t)size;
+    fclose(handle);
+
+    if (!ok) {
+        CX_ERROR("Failed to read %s.", path);
+        exit(1);
+    }
+    return true;
+}
+
+static u32 align_offset(u64 offset) {
+    return (u32)((offset + ARCHIVE_ALIGNMENT - 1) / ARCHIVE_ALIGNMENT * ARCHIVE_ALIGNMENT);
+}
+
+int main(int argc, char* argv[]) {
+    if (argc < 4) {
+        printf("usage: pack-assets <archive> <assets directory> <file>...\n");
+        return 1;
+    }
+
+    const char* outPath = argv[1];
+    const char* root = argv[2];
+
+    PackFile* files = new PackFile[argc - 3];
+    u32 count = 0;
+    for (i32 i = 3; i < argc; i++) {
+        const char* name = argv[i];
+        if (strlen(name) >= ARCHIVE_NAME_LENGTH) {
+            CX_ERROR("%s is too long a name to pack.", name);
+            return 1;
+        }
+
+        char path[512];
+        snprintf(path, sizeof(path), "%s/%s", root, name);
+        if (!read_file(path, &files[count])) {
+            CX_WARN("%s is missing, leaving it out.", path);
+            continue;
+        }
+        snprintf(files[count].Name, sizeof(files[count].Name), "%s", name);
+        count++;
+    }
+
+    // The game binary searches the index, so it goes out sorted.
+    std::sort(files, files + count, [](const PackFile& a, const PackFile& b) {
+        return strcmp(a.Name, b.Name) < 0;
+    });
+
+    ArchiveHeader header = {};
+    memcpy(header.Magic, ARCHIVE_MAGIC, sizeof(header.Magic));
+    header.Version = ARCHIVE_VERSION;
+    header.EntryCount = count;
+    header.ContentHash = ARCHIVE_HASH_SEED;
+
+    ArchiveEntry* entries = new ArchiveEntry[count];
+    memset(entries, 0, sizeof(ArchiveEntry) * count);
+    u64 offset = sizeof(ArchiveHeader) + sizeof(ArchiveEntry) * (u64)count;
+    for (u32 i = 0; i < count; i++) {
+        if (i > 0 && strcmp(files[i].Name, files[i - 1].Name) == 0) {
+            CX_ERROR("%s is packed twice.", files[i].Name);
+            return 1;
+        }
+
+        memcpy(entries[i].Name, files[i].Name, sizeof(entries[i].Name));
+        entries[i].Offset = align_offset(offset);
+        entries[i].Size = files[i].Size;
+        offset = (u64)entries[i].Offset + files[i].Size;
+
+        header.ContentHash = archive_hash(header.ContentHash, files[i].Name, strlen(files[i].Name));
+        header.ContentHash = archive_hash(header.ContentHash, files[i].Data, files[i].Size);
+    }
+
+    FILE* out = fopen(outPath, "wb");
+    if (!out) {
+        CX_ERROR("Failed to open %s for writing.", outPath);
+        return 1;
+    }
+
+    static const u8 padding[ARCHIVE_ALIGNMENT] = {};
+    bool ok = fwrite(&header, sizeof(header), 1, out) == 1
+        && fwrite(entries, sizeof(ArchiveEntry), count, out) == count;
+    u64 written = sizeof(ArchiveHeader) + sizeof(ArchiveEntry) * (u64)count;
+    for (u32 i = 0; i < count && ok; i++) {
+        u32 pad = (u32)(entries[i].Offset - written);
+        ok = fwrite(padding, 1, pad, out) == pad
+            && fwrite(files[i].Data, 1, files[i].Size, out) == files[i].Size;
+        written = (u64)entries[i].Offset + files[i].Size;
+    }
+    fclose(out);
+
+    if (!ok) {
+        CX_ERROR("Failed to write %s.", outPath);
+        return 1;
+    }
+
+    printf("packed %u files, %llu bytes, content %016llx\n", count, written, (unsigned long long)header.ContentHash);
+
+    for (u32 i = 0; i < count; i++) {
+        delete[] files[i].Data;
+    }
+    delete[] files;
+    delete[] entries;
+    return 0;
+}
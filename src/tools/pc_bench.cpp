@@ -0,0 +1,75 @@
+#include "core/base.h"
+#include "core/utils.hpp"
+#include "core/sim.hpp"
+#include "core/jobs.hpp"
+#include "bots/perfect_clear.hpp"
+
+/*
+    Perfect-clear opener benchmark: from an empty field with seeded random pieces, how often a
+    perfect clear is found in the known queue and how long the solver takes to answer. Every
+    solution found is replayed through the regular field functions to check it.
+
+    usage: pc_bench [problems] [queue length] [threads] [max nodes]
+*/
+
+int main(int argc, char* argv[]) {
+    u32 problems = argc > 1 ? (u32)atoi(argv[1]) : 200;
+    u32 queueLength = argc > 2 ? (u32)atoi(argv[2]) : 10;
+    u32 threads = argc > 3 ? (u32)atoi(argv[3]) : 0;
+
+    PCConfig config;
+    if (argc > 4) {
+        config.MaxNodes = (u64)atoll(argv[4]);
+    }
+
+    if (queueLength > PC_MAX_QUEUE) {
+        CX_ERROR("Queue length is limited to %u.", PC_MAX_QUEUE);
+        return 1;
+    }
+
+    JobPool* jobs = jobs_create(threads);
+    PCSolver* solver = pc_create(config, jobs);
+
+    u32 field[FIELD_SIZE];
+    field_clear(field);
+
+    u32 invalid = 0;
+    f64 slowest = 0.0;
+    for (u32 problem = 0; problem < problems; problem++) {
+        u32 seed = Utils::HashPCG(problem + 1);
+        u32 currentID = sim_random_shape_id(seed);
+        u32 queue[PC_MAX_QUEUE];
+        for (u32 i = 0; i < queueLength; i++) {
+            queue[i] = sim_random_shape_id(seed);
+        }
+
+        f64 before = pc_get_stats(solver).Seconds;
+        PCSolution solution;
+        if (pc_solve(solver, field, currentID, queue, queueLength, true, &solution) == PCOutcome::Solved) {
+            invalid += !pc_verify(field, currentID, queue, queueLength, solution);
+        }
+        f64 seconds = pc_get_stats(solver).Seconds - before;
+        slowest = seconds > slowest ? seconds : slowest;
+    }
+
+    PCStats stats = pc_get_stats(solver);
+    printf("%u problems, %u pieces queued, %llu nodes max, %u threads\n", problems, queueLength, config.MaxNodes, jobs_thread_count(jobs));
+    printf(
+        "solved %llu (%llu invalid)  impossible %llu  out of budget %llu\n",
+        stats.Solved,
+        (u64)invalid,
+        stats.Impossible,
+        stats.OutOfBudget
+    );
+    printf(
+        "%.3f ms avg  %.3f ms worst  %llu nodes  %llu memo hits\n",
+        1000.0 * stats.Seconds / (f64)problems,
+        1000.0 * slowest,
+        stats.Nodes,
+        stats.MemoHits
+    );
+
+    pc_destroy(solver);
+    jobs_destroy(jobs);
+    return invalid == 0 ? 0 : 1;
+}
@@ -0,0 +1,99 @@
+#include "core/base.h"
+#include "core/utils.hpp"
+#include "core/sim.hpp"
+#include "bots/tbp.hpp"
+
+/*
+    Runs games for an external engine speaking the Tetris Bot Protocol on our stdin/stdout, e.g.
+    with the engine's stdout piped into ours and ours into its stdin. Results go to stderr so
+    they never mix with protocol messages.
+
+    usage: tbp_frontend [games] [max pieces] [seed]
+*/
+
+#define TBP_MAX_SUGGESTIONS 16
+
+static bool tbp_expect(TBPConnection& connection, TBPMessageType expected) {
+    for (;;) {
+        TBPMessageType type = tbp_read_message(connection);
+        if (type == expected) {
+            return true;
+        }
+        if (type == TBPMessageType::Error || connection.ReadBuffer[0] == '\0') {
+            fprintf(stderr, "bot error or disconnect: %s\n", connection.ReadBuffer);
+            return false;
+        }
+        // Anything else (unknown messages are allowed by the spec) is skipped.
+    }
+}
+
+int main(int argc, char* argv[]) {
+    u32 games = argc > 1 ? (u32)atoi(argv[1]) : 1;
+    u32 maxPieces = argc > 2 ? (u32)atoi(argv[2]) : 10000;
+    u32 seed = argc > 3 ? (u32)atoi(argv[3]) : 1;
+
+    static TBPConnection connection;
+    tbp_init(connection, stdin, stdout);
+
+    if (!tbp_expect(connection, TBPMessageType::Info)) {
+        return 1;
+    }
+    tbp_send_rules(connection);
+    if (!tbp_expect(connection, TBPMessageType::Ready)) {
+        return 1;
+    }
+
+    Utils::Clock clock;
+    u64 totalPieces = 0;
+    f64 totalSeconds = 0.0;
+
+    for (u32 game = 0; game < games; game++) {
+        SimState state;
+        sim_reset(state, Utils::HashPCG(seed + game));
+        tbp_send_start(connection, state);
+        clock.Tick();
+
+        while (!state.IsOver && state.Pieces < maxPieces) {
+            tbp_send_suggest(connection);
+            if (!tbp_expect(connection, TBPMessageType::Suggestion)) {
+                return 1;
+            }
+
+            TBPMove moves[TBP_MAX_SUGGESTIONS];
+            u32 count = tbp_parse_suggestion(connection, moves, TBP_MAX_SUGGESTIONS);
+
+            // Take the bot's most preferred move that our rules can reach.
+            Placement placement;
+            u32 chosen = 0;
+            while (chosen < count && !tbp_move_to_placement(state, moves[chosen], &placement)) {
+                chosen++;
+            }
+            if (chosen == count) {
+                fprintf(stderr, "game %u: no playable suggestion, forfeiting\n", game);
+                break;
+            }
+
+            sim_apply_placement(state, placement);
+            tbp_send_play(connection, moves[chosen]);
+
+            if (placement.Swap) {
+                // Our swap is not a TBP hold, so rather than let the bot's idea of the hold slot
+                // drift from ours, restart it from the real state.
+                tbp_send_stop(connection);
+                tbp_send_start(connection, state);
+            } else {
+                tbp_send_new_piece(connection, state.NextID);
+            }
+        }
+
+        tbp_send_stop(connection);
+        f64 seconds = clock.Tick();
+        totalSeconds += seconds;
+        totalPieces += state.Pieces;
+        fprintf(stderr, "game %u: score %u, lines %u, pieces %u%s\n", game, state.Score, state.Lines, state.Pieces, state.IsOver ? ", topped out" : "");
+    }
+
+    tbp_send_quit(connection);
+    fprintf(stderr, "%llu pieces in %.2fs (%.0f moves/s)\n", totalPieces, totalSeconds, totalSeconds > 0.0 ? (f64)totalPieces / totalSeconds : 0.0);
+    return 0;
+}
@@ -0,0 +1,93 @@
+#include "core/base.h"
+#include "core/jobs.hpp"
+#include "bots/tournament.hpp"
+
+/*
+    Runs a versus tournament between bots on every core and prints the standings with Elo and
+    Glicko-2 ratings. Agents are given as specs, see tournament_parse_agent, e.g.
+
+        tetris-tournament --swiss 7 default=greedy tuned=greedy:weights.txt net=network:board.ttnn
+
+    usage: tetris-tournament [--swiss rounds] [--games per pairing] [--ticks max] [--threads n] [--seed n] agent...
+*/
+
+int main(int argc, char* argv[]) {
+    TournamentConfig config;
+    u32 threads = 0;
+
+    TournamentAgent* agents = new TournamentAgent[TOURNAMENT_MAX_AGENTS];
+    u32 agentCount = 0;
+
+    for (i32 i = 1; i < argc; i++) {
+        const char* arg = argv[i];
+        bool hasValue = i + 1 < argc;
+        if (strcmp(arg, "--swiss") == 0 && hasValue) {
+            config.Format = TournamentFormat::Swiss;
+            config.Rounds = (u32)atoi(argv[++i]);
+        } else if (strcmp(arg, "--games") == 0 && hasValue) {
+            config.GamesPerPairing = (u32)atoi(argv[++i]);
+        } else if (strcmp(arg, "--ticks") == 0 && hasValue) {
+            config.MaxTicks = (u32)atoi(argv[++i]);
+        } else if (strcmp(arg, "--threads") == 0 && hasValue) {
+            threads = (u32)atoi(argv[++i]);
+        } else if (strcmp(arg, "--seed") == 0 && hasValue) {
+            config.Seed = (u32)atoi(argv[++i]);
+        } else if (agentCount < TOURNAMENT_MAX_AGENTS && tournament_parse_agent(arg, &agents[agentCount])) {
+            agentCount++;
+        } else {
+            return 1;
+        }
+    }
+
+    if (agentCount < 2) {
+        printf("usage: tetris-tournament [--swiss rounds] [--games per pairing] [--ticks max] [--threads n] [--seed n] agent...\n");
+        printf("agents: [name=]greedy[:weights file] or [name=]network:<network file>, at least two\n");
+        return 1;
+    }
+
+    JobPool* jobs = jobs_create(threads);
+    Tournament* tournament = tournament_create(config, agents, agentCount, jobs);
+    tournament_run(tournament);
+
+    TournamentStanding* standings = new TournamentStanding[agentCount];
+    u32 count = tournament_get_standings(tournament, standings);
+    TournamentStats stats = tournament_get_stats(tournament);
+
+    printf(
+        "%s, %u agents, %llu games (%llu unfinished) on %u threads in %.2f s, %.1f games/s, %.0f ticks/s\n",
+        config.Format == TournamentFormat::Swiss ? "swiss" : "round robin",
+        agentCount,
+        stats.Games,
+        stats.Unfinished,
+        jobs_thread_count(jobs),
+        stats.Seconds,
+        stats.Seconds > 0.0 ? (f64)stats.Games / stats.Seconds : 0.0,
+        stats.Seconds > 0.0 ? (f64)stats.Ticks / stats.Seconds : 0.0
+    );
+    printf("%4s  %-24s %6s %6s %6s %6s %8s %8s %8s %6s\n", "rank", "agent", "games", "wins", "draws", "losses", "points", "elo", "glicko", "rd");
+    for (u32 i = 0; i < count; i++) {
+        const TournamentStanding& standing = standings[i];
+        printf(
+            "%4u  %-24s %6u %6u %6u %6u %8.1f %8.1f %8.1f %6.1f\n",
+            i + 1,
+            agents[standing.Agent].Name,
+            standing.Games,
+            standing.Wins,
+            standing.Draws,
+            standing.Losses,
+            standing.Points,
+            standing.Elo,
+            standing.Glicko.Rating,
+            standing.Glicko.Deviation
+        );
+    }
+
+    delete[] standings;
+    tournament_destroy(tournament);
+    jobs_destroy(jobs);
+    for (u32 i = 0; i < agentCount; i++) {
+        tournament_free_agent(&agents[i]);
+    }
+    delete[] agents;
+    return 0;
+}
@@ -0,0 +1,91 @@
+#include "core/base.h"
+#include "core/utils.hpp"
+#include "core/versus.hpp"
+#include "bots/driver.hpp"
+#include "bots/evaluator.hpp"
+
+/*
+    Plays seeded versus matches between two greedy evaluators, each driven through the regular
+    input-level rules, and reports the results alongside how fast matches simulate. Without
+    weight files both sides play the default weights, which makes a useful sanity check: with
+    the same pieces and garbage on both sides every match should mirror, never a win.
+
+    usage: versus_bench [matches] [max ticks] [weights A] [weights B]
+*/
+
+int main(int argc, char* argv[]) {
+    u32 matches = argc > 1 ? (u32)atoi(argv[1]) : 20;
+    u32 maxTicks = argc > 2 ? (u32)atoi(argv[2]) : 60 * VERSUS_TICK_RATE * 5;
+
+    EvalWeights weights[VERSUS_PLAYER_COUNT];
+    for (u32 p = 0; p < VERSUS_PLAYER_COUNT; p++) {
+        weights[p] = evaluator_default_weights();
+        if (argc > 3 + (i32)p && !evaluator_load_weights(argv[3 + p], &weights[p])) {
+            return 1;
+        }
+    }
+
+    u32 wins[VERSUS_PLAYER_COUNT] = {};
+    u32 draws = 0;
+    u32 timeouts = 0;
+    u64 ticks = 0;
+    u64 pieces = 0;
+    u64 garbage = 0;
+    Utils::Clock timer;
+
+    for (u32 m = 0; m < matches; m++) {
+        VersusMatch match;
+        versus_reset(match, Utils::HashPCG(m + 1), Utils::HashPCG(m + 0x9e3779b9));
+
+        InputDriver drivers[VERSUS_PLAYER_COUNT] = {};
+        while (match.Outcome == VersusOutcome::Playing && match.Tick < maxTicks) {
+            GameInput inputs[VERSUS_PLAYER_COUNT];
+            for (u32 p = 0; p < VERSUS_PLAYER_COUNT; p++) {
+                const GameSim& sim = match.Players[p].Sim;
+                if (!drivers[p].Active) {
+                    Placement placement;
+                    if (evaluator_pick_placement(driver_sim_state(sim), weights[p], sim.CanSwap, &placement)) {
+                        driver_start(drivers[p], placement);
+                    }
+                }
+                inputs[p] = driver_next_input(drivers[p], sim);
+            }
+            versus_step(match, inputs);
+        }
+
+        switch (match.Outcome) {
+            case VersusOutcome::Won:
+                wins[match.Winner]++;
+                break;
+            case VersusOutcome::Draw:
+                draws++;
+                break;
+            case VersusOutcome::Playing:
+                timeouts++;
+                break;
+        }
+
+        ticks += match.Tick;
+        for (u32 p = 0; p < VERSUS_PLAYER_COUNT; p++) {
+            pieces += match.Players[p].PiecesLocked;
+            garbage += match.Players[p].LinesReceived;
+        }
+    }
+
+    f64 seconds = timer.Tick();
+    printf("%u matches, %u ticks max\n", matches, maxTicks);
+    printf("wins A %u  wins B %u  draws %u  unfinished %u\n", wins[0], wins[1], draws, timeouts);
+    printf(
+        "avg ticks %.1f  avg pieces per player %.1f  avg garbage received per player %.1f\n",
+        matches ? (f64)ticks / matches : 0.0,
+        matches ? (f64)pieces / (VERSUS_PLAYER_COUNT * matches) : 0.0,
+        matches ? (f64)garbage / (VERSUS_PLAYER_COUNT * matches) : 0.0
+    );
+    printf(
+        "%.3f s, %.0f ticks/s (%.0fx real time)\n",
+        seconds,
+        seconds > 0.0 ? (f64)ticks / seconds : 0.0,
+        seconds > 0.0 ? (f64)ticks / seconds / VERSUS_TICK_RATE : 0.0
+    );
+    return 0;
+}
@@ -0,0 +1,62 @@
+#include "core/base.h"
+#include "core/utils.hpp"
+#include "core/jobs.hpp"
+#include "bots/evaluator.hpp"
+#include "bots/tuner.hpp"
+
+/*
+    Tunes the evaluator weights with CMA-ES and writes the result to a weights file after every
+    generation, so a long run can be stopped at any point.
+
+    usage: weight_tuner [generations] [games per candidate] [max pieces] [threads] [output] [initial weights]
+*/
+
+int main(int argc, char* argv[]) {
+    u64 generations, games, maxPieces, threads;
+    if (!Utils::ParseCount(argc, argv, 1, 50, &generations)
+        || !Utils::ParseCount(argc, argv, 2, 100, &games)
+        || !Utils::ParseCount(argc, argv, 3, 500, &maxPieces)
+        || !Utils::ParseCount(argc, argv, 4, 0, &threads)
+        || generations > 0xffffffff || games > 0xffffffff || maxPieces > 0xffffffff || threads > 0xffffffff) {
+        printf("usage: weight_tuner [generations] [games per candidate] [max pieces] [threads] [output] [initial weights]\n");
+        printf("generations, games, pieces and threads must be positive numbers; threads defaults to one per core\n");
+        return 1;
+    }
+    const char* outputPath = argc > 5 ? argv[5] : "weights.txt";
+
+    TunerConfig config;
+    config.GamesPerCandidate = (u32)games;
+    config.MaxPieces = (u32)maxPieces;
+
+    EvalWeights initial = evaluator_default_weights();
+    if (argc > 6 && !evaluator_load_weights(argv[6], &initial)) {
+        return 1;
+    }
+
+    JobPool* jobs = jobs_create((u32)threads);
+    Tuner* tuner = tuner_create(config, initial, jobs);
+
+    for (u32 i = 0; i < generations; i++) {
+        tuner_step(tuner);
+        TunerStats stats = tuner_get_stats(tuner);
+        printf(
+            "gen %4u  best %8.2f  mean %8.2f  sigma %.4f  %.0f games/s  %.0f pieces/s\n",
+            stats.Generation,
+            stats.BestFitness,
+            stats.MeanFitness,
+            stats.Sigma,
+            (f64)stats.GamesPlayed / stats.Seconds,
+            (f64)stats.PiecesPlayed / stats.Seconds
+        );
+        evaluator_save_weights(outputPath, tuner_get_mean(tuner));
+    }
+
+    EvalWeights result = tuner_get_mean(tuner);
+    for (u32 i = 0; i < EVAL_FEATURE_COUNT; i++) {
+        printf("%-18s %9.5f\n", evaluator_feature_name(i), result.Values[i]);
+    }
+
+    tuner_destroy(tuner);
+    jobs_destroy(jobs);
+    return 0;
+}